@@ -0,0 +1,48 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Heap allocation accounting. The global operator new is only replaced when the
+ * program is built with TLK_COUNT_ALLOCATIONS (cmake -DTLK_COUNT_ALLOCATIONS=ON),
+ * otherwise all counters stay at 0. */
+
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <cstddef>
+
+/** Returns weither allocations are counted in this build or not. */
+bool allocationCountingEnabled();
+
+/** Returns the number of heap allocations since the start of the program. */
+unsigned long allocationCount();
+
+/** Returns the number of bytes allocated on the heap since the start of the program. */
+size_t allocatedBytes();
+
+/**
+ * Counts the heap allocations made during its lifetime.
+ *
+ * Usage :
+ *     AllocationScope scope;
+ *     linkage.run();
+ *     assert(scope.count() == 0);
+ */
+class AllocationScope {
+public:
+    /** Constructor */
+    AllocationScope();
+
+    /** Returns the number of allocations since construction. */
+    unsigned long count() const;
+
+    /** Returns the number of bytes allocated since construction. */
+    size_t bytes() const;
+
+private:
+    unsigned long _startCount;
+    size_t _startBytes;
+};
+
+#endif // ALLOCATION_H
@@ -0,0 +1,157 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Anytime linkage : the linkage stops when a deadline, a number of merges or a
+ * cancellation request is reached, and the current clustering is returned. */
+
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+#include "cluster.h"
+#include "trace.h"
+
+/**
+ * Cancellation request, shared between the thread running the linkage and the
+ * threads that may cancel it.
+ */
+class CancellationToken {
+public:
+    /** Asks the linkage to stop (thread safe). */
+    void cancel() {
+        _cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    /** Returns weither cancel() was called. */
+    bool cancelled() const {
+        return _cancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+    // private attributes
+    std::atomic<bool> _cancelled {false};
+};
+
+/** Limits of an anytime linkage. Default : no limit. */
+struct LinkageBudget {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    unsigned long maxMerges = std::numeric_limits<unsigned long>::max();
+    const CancellationToken *token = nullptr; // not owned
+
+    /** Budget of the given number of seconds from now (<= 0 : no deadline). */
+    static LinkageBudget seconds(double seconds) {
+        LinkageBudget budget;
+        if(seconds > 0.) {
+            budget.deadline = std::chrono::steady_clock::now()
+                    + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(seconds));
+        }
+        return budget;
+    }
+
+    /** Returns weither the deadline is passed or the linkage was cancelled (merges are not checked). */
+    bool expired() const {
+        return (token && token->cancelled()) || std::chrono::steady_clock::now() >= deadline;
+    }
+};
+
+enum class StopReason {
+    COMPLETED,   // no more clusters could be linked
+    DEADLINE,
+    WORK_BUDGET, // maxMerges reached
+    CANCELLED
+};
+
+/** Clustering returned by an anytime linkage. */
+struct AnytimeResult {
+    std::vector<Cluster> clusters; // current clusters, followed by the outliers, validated
+                                   // (labelled with their model family in mixed mode)
+    unsigned long merges = 0;
+    StopReason reason = StopReason::COMPLETED;
+    bool partial = false;          // true if the linkage did not complete
+};
+
+/**
+ * Runs a linkage engine (TLinkage, JLinkage, LshLinkage) until it completes or the
+ * budget runs out. The budget is checked between 2 merges : a merge is never
+ * interrupted, so the linkage overruns the deadline by at most 1 merge. Give the same
+ * budget to the constructor of the engine so that its setup counts : the setup is
+ * checked between rows of distances, and if it was interrupted the result holds the
+ * initial clusters. Observers of the engine are given the final clustering in both
+ * cases (see Linkage::finish()). A partial clustering is a valid one, only less merged : its
+ * clusters are validated like those of a complete linkage.
+ *
+ * @param linkage the engine, already set up
+ * @param budget limits of the linkage
+ * @param outliers clusters left out of the linkage, appended to the result
+ * @param nValidated number of biggest clusters to validate (see validateNBiggestClusters, 0 : none)
+ * @param nLines mixed models : number of line models (first columns of the space), each
+ *        cluster is labelled with its best model family (see Cluster::family()).
+ *        -1 : clusters are not labelled
+ * @return the clustering
+ */
+template<typename Engine>
+AnytimeResult anytimeLinkage(Engine &linkage,
+                             const LinkageBudget &budget,
+                             const std::vector<Cluster> &outliers = {},
+                             unsigned int nValidated = 1,
+                             long nLines = -1) {
+    TRACE_SCOPE("anytime linkage");
+    AnytimeResult result;
+
+    while(true) {
+        if(linkage.interrupted()) {
+            result.reason = budget.token && budget.token->cancelled() ? StopReason::CANCELLED : StopReason::DEADLINE;
+            break;
+        }
+        if(budget.token && budget.token->cancelled()) {
+            result.reason = StopReason::CANCELLED;
+            break;
+        }
+        if(result.merges >= budget.maxMerges) {
+            result.reason = StopReason::WORK_BUDGET;
+            break;
+        }
+        if(std::chrono::steady_clock::now() >= budget.deadline) {
+            result.reason = StopReason::DEADLINE;
+            break;
+        }
+        if(!linkage.step()) {
+            result.reason = StopReason::COMPLETED;
+            break;
+        }
+        result.merges++;
+    }
+    result.partial = result.reason != StopReason::COMPLETED;
+
+    if(result.partial) {
+        std::cout << "[DEBUG] Linkage stopped after " << result.merges << " merges ("
+                  << (result.reason == StopReason::DEADLINE ? "deadline"
+                      : result.reason == StopReason::WORK_BUDGET ? "work budget" : "cancelled")
+                  << "), returning a partial clustering." << std::endl;
+    }
+
+    // last snapshot for the observers, also when stopped
+    linkage.finish();
+
+    result.clusters = linkage.clusters();
+    if(nLines >= 0) {
+        auto rows = linkage.activeRows();
+        for(unsigned long i = 0; i < rows.size(); i++) {
+            result.clusters[i].setFamily(linkage.space().bestFamily(rows[i], nLines));
+        }
+    }
+    result.clusters.insert(result.clusters.end(), outliers.begin(), outliers.end());
+    if(nValidated > 0 && !result.clusters.empty()) {
+        validateNBiggestClusters(std::min<unsigned long>(nValidated, result.clusters.size()), result.clusters);
+    }
+    return result;
+}
+
+#endif // ANYTIME_H
@@ -48,7 +48,18 @@ public:
     /** Value of the preference function accoding to the given point. */
     double PFValue(const Point &p);
 
-    /** Draws and returns n circle models from the given data set. */
+    /**
+     * Geometric refinement of the circle : Gauss-Newton minimization of the sum of the
+     * squared distances from the given points to the circle, starting from the current
+     * circle (typically an algebraic fit, see Moments::fitCircle).
+     *
+     * @param points the points to fit
+     * @param iterations max. number of iterations
+     * @return the refined circle
+     */
+    Circle refine(const std::vector<std::shared_ptr<Point>> &points, int iterations = CIRCLE_REFINEMENT_ITERATIONS) const;
+
+    /** Draws and returns n circle models from the given data set (fewer if none are found after 10*n draws). */
     static std::vector<Circle> drawModels(unsigned int n, const PointPool &dataSet, int windowWidth, int windowHeight);
 
 
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <set>
+#include <unordered_map>
 #include <chrono> // remove after testing
 #include <omp.h>
 
@@ -17,7 +18,10 @@
 #include "pointpool.h"
 #include "image.h"
 #include "circle.h"
+#include "preference.h"
+#include "moments.h"
 
+class ConsensusMatrix;
 
 /** Represents a cluster of points, which can eventually be view as a model hypothesis.
  *  A cluster is a vector of points from the 2D space. */
@@ -42,6 +46,46 @@ public:
      *  of size N */
     static std::vector<Cluster> clusterize(const PointPool &points);
 
+    /**
+     * Factory method that generates the initial clusters of the linkage from the
+     * preference functions of the points.
+     *
+     * Points with an empty preference function (matching with no model) cannot be
+     * linked and are directly moved to the outliers. Points with identical preference
+     * functions start in the same cluster (optionally after quantization, see
+     * PREFERENCE_QUANTIZATION).
+     *
+     * @param points the data set
+     * @param preferences the preference functions of the points (1 row per point)
+     * @param outliers output singleton clusters of the points with an empty preference function
+     * @return the initial clusters
+     */
+    static std::vector<Cluster> clusterizeByPreference(const PointPool &points,
+                                                       const PreferenceMatrix &preferences,
+                                                       std::vector<Cluster> &outliers);
+
+    /** Same as above, computing the preference functions from line models. */
+    static std::vector<Cluster> clusterizeByPreference(const PointPool &points,
+                                                       const std::vector<Line> &models,
+                                                       std::vector<Cluster> &outliers);
+
+    /** Same as above, computing the preference functions from circle models. */
+    static std::vector<Cluster> clusterizeByPreference(const PointPool &points,
+                                                       const std::vector<Circle> &models,
+                                                       std::vector<Cluster> &outliers);
+
+    /**
+     * Same as clusterizeByPreference, for J-Linkage : points with identical consensus
+     * sets start in the same cluster, points with an empty consensus set are outliers.
+     *
+     * @param points the data set
+     * @param consensus the consensus sets of the points (1 row per point)
+     * @param outliers output singleton clusters of the points with an empty consensus set
+     * @return the initial clusters
+     */
+    static std::vector<Cluster> clusterizeByConsensus(const PointPool &points,
+                                                      const ConsensusMatrix &consensus,
+                                                      std::vector<Cluster> &outliers);
 
     /** Stream operator << redefinition. */
     friend std::ostream &operator<<(std::ostream &out, Cluster &cluster);
@@ -65,13 +109,38 @@ public:
     bool operator==(const Cluster &other) const;
 
     /** Accessor for private _points field. */
-    std::vector<std::shared_ptr<Point>> points() const;
+    const std::vector<std::shared_ptr<Point>> &points() const;
 
     /** Adds point to cluster. */
     void addPoint(std::shared_ptr<Point>p);
 
     /** Adds points contained in the given vector to cluster. */
-    void addPoints(std::vector<std::shared_ptr<Point>> points);
+    void addPoints(const std::vector<std::shared_ptr<Point>> &points);
+
+    /** Adds the points of the given cluster, merging the moments in O(1). */
+    void merge(const Cluster &other);
+
+    /** Accessor for private _moments field. */
+    const Moments &moments() const;
+
+    /**
+     * Returns the total least squares line of the cluster, computed from its moments.
+     * Asserts that the cluster contains at least 2 points.
+     */
+    Line lineModel() const;
+
+    /**
+     * Returns the circle model of the cluster : algebraic (Taubin) fit computed from its
+     * moments, optionally refined with a geometric fit on its points.
+     * Asserts that the cluster contains at least 3 points.
+     */
+    Circle circleModel(bool refine = false) const;
+
+    /** Returns the best model family of the cluster (NONE unless labelled, see anytimeLinkage). */
+    ModelFamily family() const;
+
+    /** Labels the cluster with its best model family (mixed models). */
+    void setFamily(ModelFamily family);
 
     /** Accepts all points. */
     void validate();
@@ -81,7 +150,7 @@ public:
 
     /** Returns the size of the cluster, i.e. the number of elements
      *  that it contains. */
-    int size();
+    int size() const;
 
     /**
      * Displays the given vectors, automatically assigning each one a color.
@@ -116,8 +185,10 @@ public:
                                         cv::Mat &image);
 
     /**
-     * @brief displayModels
-     * @param clusters
+     * Displays the model of each validated cluster : its circle if the cluster is
+     * labelled as a circle (see family()), its line otherwise.
+     *
+     * @param clusters the clusters to be displayed.
      */
     static void displayModels(const std::vector<Cluster> &clusters,
                               int windowWidth,
@@ -152,7 +223,7 @@ public:
     /**
      * @return true if all points were validated.
      */
-    bool isModel();
+    bool isModel() const;
 
 
 private:
@@ -163,6 +234,8 @@ private:
     // attributes
 
     std::vector<std::shared_ptr<Point>> _points;                // vector of points composing the cluster
+    Moments _moments;                                           // moment sums of the points
+    ModelFamily _family = ModelFamily::NONE;                    // best model family (mixed models)
 
 };
 
@@ -185,10 +258,16 @@ double jaccard(
  * @return
  */
 double tanimoto(
-        std::vector<double> a,
-        std::vector<double> b
+        const std::vector<double> &a,
+        const std::vector<double> &b
         );
 
+/**
+ * Returns the tanimoto distance (between 0 and 1) from 2 preference
+ * functions of the given size, stored contiguously.
+ */
+double tanimoto(const double *a, const double *b, unsigned long size);
+
 /** Performs linking action and updates given parameters. */
 bool link(
         std::vector<Cluster> &clusters,
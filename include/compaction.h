@@ -0,0 +1,172 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Hypothesis compaction : sampled models that explain almost no points or that
+ * have the same consensus set as a better model are dropped before the linkage,
+ * so that every preference function gets shorter. */
+
+#ifndef COMPACTION_H
+#define COMPACTION_H
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "pointpool.h"
+#include "settings.h"
+#include "trace.h"
+
+#define COMPACTION_BANDS 8 // MinHash bands (2 hashes per band)
+
+/** splitmix64 finalizer, used as a family of hash functions on point indexes. */
+inline uint64_t compactionHash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Compacts a set of models.
+ *
+ * 1. Preemptive scoring (if preemptiveSize > 0) : every model is first scored on an
+ *    evenly spread subset of preemptiveSize points, and models whose expected
+ *    consensus size is below half of minConsensus are dropped without being scored
+ *    on the whole data set.
+ * 2. Models whose consensus set (points with PF > 0) has less than minConsensus
+ *    points are dropped.
+ * 3. Models are visited from the biggest consensus set to the smallest. A model is
+ *    dropped if the Jaccard index of its consensus set and the one of an already kept
+ *    model is at least similarity. Candidates are found with MinHash signatures
+ *    hashed by bands, so that only near-identical sets are compared.
+ *
+ * Model must provide PFValue(const Point &).
+ *
+ * @param dataSet the data set
+ * @param models the sampled models
+ * @param minConsensus minimal size of a consensus set
+ * @param similarity Jaccard index above which 2 models are the same
+ * @param preemptiveSize size of the preemptive subset (0 : no preemptive scoring)
+ * @return the kept models, biggest consensus sets first
+ */
+template<typename Model>
+std::vector<Model> compactModels(const PointPool &dataSet,
+                                 std::vector<Model> models,
+                                 unsigned int minConsensus = COMPACTION_MIN_CONSENSUS,
+                                 double similarity = COMPACTION_SIMILARITY,
+                                 unsigned int preemptiveSize = COMPACTION_PREEMPTIVE_SIZE) {
+    TRACE_SCOPE_ARG("compaction", "models", models.size());
+
+    const unsigned long n = dataSet.size();
+    const unsigned long sampled = models.size();
+
+    // 1. preemptive scoring
+    if(preemptiveSize > 0 && preemptiveSize < n) {
+        std::vector<char> keep(models.size(), 0);
+        const double minScore = 0.5*minConsensus*preemptiveSize/n;
+
+        #pragma omp parallel for schedule(dynamic)
+        for(long m = 0; m < static_cast<long>(models.size()); m++) {
+            unsigned long score = 0;
+            for(unsigned long s = 0; s < preemptiveSize; s++) {
+                score += models[m].PFValue(*dataSet[s*n/preemptiveSize]) > 0.;
+            }
+            keep[m] = score >= minScore;
+        }
+
+        std::vector<Model> kept;
+        for(unsigned long m = 0; m < models.size(); m++) {
+            if(keep[m]) {
+                kept.emplace_back(models[m]);
+            }
+        }
+        models = std::move(kept);
+    }
+    const unsigned long preempted = sampled - models.size();
+
+    // 2. consensus sets (packed bitsets) and their MinHash signatures
+    const unsigned long words = (n + 63)/64;
+    std::vector<uint64_t> bits(models.size()*words, 0);
+    std::vector<unsigned long> sizes(models.size(), 0);
+    std::vector<uint64_t> signatures(models.size()*2*COMPACTION_BANDS, ~uint64_t(0));
+
+    #pragma omp parallel for schedule(dynamic)
+    for(long m = 0; m < static_cast<long>(models.size()); m++) {
+        auto set = bits.data() + m*words;
+        auto signature = signatures.data() + m*2*COMPACTION_BANDS;
+
+        for(unsigned long i = 0; i < n; i++) {
+            if(models[m].PFValue(*dataSet[i]) <= 0.) {
+                continue;
+            }
+            set[i/64] |= uint64_t(1) << (i % 64);
+            sizes[m]++;
+            for(int h = 0; h < 2*COMPACTION_BANDS; h++) {
+                signature[h] = std::min(signature[h], compactionHash(i*2*COMPACTION_BANDS + h));
+            }
+        }
+    }
+
+    // 3. near-duplicates, biggest consensus sets first
+    std::vector<unsigned long> order;
+    for(unsigned long m = 0; m < models.size(); m++) {
+        if(sizes[m] >= minConsensus) {
+            order.emplace_back(m);
+        }
+    }
+    const unsigned long weak = models.size() - order.size();
+    std::stable_sort(order.begin(), order.end(), [&](unsigned long m1, unsigned long m2) {
+        return sizes[m1] > sizes[m2];
+    });
+
+    auto jaccard = [&](unsigned long m1, unsigned long m2) {
+        auto s1 = bits.data() + m1*words;
+        auto s2 = bits.data() + m2*words;
+        unsigned long common = 0;
+        for(unsigned long w = 0; w < words; w++) {
+            common += __builtin_popcountll(s1[w] & s2[w]);
+        }
+        return static_cast<double>(common)/(sizes[m1] + sizes[m2] - common);
+    };
+
+    std::vector<std::unordered_map<uint64_t, std::vector<unsigned long>>> buckets(COMPACTION_BANDS);
+    std::vector<Model> compacted;
+
+    for(auto m : order) {
+        auto signature = signatures.data() + m*2*COMPACTION_BANDS;
+        auto duplicate = false;
+
+        for(int band = 0; band < COMPACTION_BANDS && !duplicate; band++) {
+            auto key = compactionHash(signature[2*band]) ^ signature[2*band + 1];
+            auto it = buckets[band].find(key);
+            if(it == buckets[band].end()) {
+                continue;
+            }
+            for(auto other : it->second) {
+                if(jaccard(m, other) >= similarity) {
+                    duplicate = true;
+                    break;
+                }
+            }
+        }
+        if(duplicate) {
+            continue;
+        }
+
+        for(int band = 0; band < COMPACTION_BANDS; band++) {
+            auto key = compactionHash(signature[2*band]) ^ signature[2*band + 1];
+            buckets[band][key].emplace_back(m);
+        }
+        compacted.emplace_back(models[m]);
+    }
+
+    std::cout << "[DEBUG] Hypothesis compaction : " << sampled << " -> " << compacted.size() << " models ("
+              << preempted << " preempted, " << weak << " weak, "
+              << order.size() - compacted.size() << " duplicates)" << std::endl;
+    return compacted;
+}
+
+#endif // COMPACTION_H
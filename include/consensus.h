@@ -0,0 +1,108 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026 */
+
+#ifndef CONSENSUS_H
+#define CONSENSUS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "preference.h"
+
+/**
+ * Binary preference matrix used by J-Linkage : the i-th row is the consensus set of the
+ * i-th element (point or cluster), stored as a packed bitset with 1 bit per model.
+ * The j-th bit is set if the element is an inlier of the j-th model.
+ */
+class ConsensusMatrix {
+public:
+    /** Constructors */
+    ConsensusMatrix();
+
+    /**
+     * Thresholds the given preference matrix : an element is an inlier of a model if its
+     * preference value is > 0, i.e. if its residual is below the PF cut-off (5*TAU).
+     */
+    explicit ConsensusMatrix(const PreferenceMatrix &preferences);
+
+    /** Empty consensus sets. */
+    ConsensusMatrix(unsigned long rows, unsigned long cols);
+
+    /**
+     * Factory method that computes the consensus set of each point of the data set,
+     * directly from the residuals (PFValue > 0) : no dense preference matrix is built.
+     */
+    static ConsensusMatrix build(const PointPool &dataSet, const std::vector<Line> &models);
+
+    /** Same as above, for circle models. */
+    static ConsensusMatrix build(const PointPool &dataSet, const std::vector<Circle> &models);
+
+    /**
+     * Factory method that computes the consensus set of each cluster, i.e. the
+     * intersection of the consensus sets of its points.
+     */
+    static ConsensusMatrix build(const std::vector<Cluster> &clusters, const std::vector<Line> &models);
+
+    /** Same as above, for circle models. */
+    static ConsensusMatrix build(const std::vector<Cluster> &clusters, const std::vector<Circle> &models);
+
+    /** Mixed model mode : line models first, then circle models (see PreferenceMatrix::build). */
+    static ConsensusMatrix build(const PointPool &dataSet,
+                                 const std::vector<Line> &lines,
+                                 const std::vector<Circle> &circles);
+
+    /** Same as above, for clusters. */
+    static ConsensusMatrix build(const std::vector<Cluster> &clusters,
+                                 const std::vector<Line> &lines,
+                                 const std::vector<Circle> &circles);
+
+    /** Returns the number of rows (points or clusters). */
+    unsigned long rows() const;
+
+    /** Returns the number of columns (models). */
+    unsigned long cols() const;
+
+    /** Returns weither the i-th element is an inlier of the j-th model or not. */
+    bool test(unsigned long i, unsigned long j) const;
+
+    /** Returns the words of the consensus set of the i-th element. */
+    uint64_t *row(unsigned long i);
+
+    /** Returns the words of the consensus set of the i-th element. */
+    const uint64_t *row(unsigned long i) const;
+
+    /** Returns the number of 64 bits words per row. */
+    unsigned long words() const;
+
+    /** Returns the size of the consensus set of the i-th element. */
+    unsigned long count(unsigned long i) const;
+
+    /** Returns the Jaccard distance between the consensus sets of elements i and j. */
+    double distance(unsigned long i, unsigned long j) const;
+
+    /** Replaces the consensus set of element i by its intersection with the one of element j. */
+    void merge(unsigned long i, unsigned long j);
+
+    /**
+     * Returns the family of the models whose consensus sets contain the i-th element,
+     * assuming the first nLines columns are line models and the other ones circle models.
+     * Same rule as PreferenceMatrix::bestFamily() with binary preference values : the
+     * best value of a family is 1 if any of its models contains the element, so the label
+     * does not depend on how many models of each family were sampled. Lines win ties.
+     */
+    ModelFamily bestFamily(unsigned long i, unsigned long nLines) const;
+
+    /** Returns the memory used by the bitsets, in bytes. */
+    size_t bytes() const;
+
+private:
+    // private attributes
+    unsigned long _rows;
+    unsigned long _cols;
+    unsigned long _words;          // number of 64 bits words per row
+    std::vector<uint64_t> _bits;
+};
+
+#endif // CONSENSUS_H
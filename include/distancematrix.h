@@ -0,0 +1,69 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026 */
+
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <vector>
+#include <cstddef>
+
+#define DISTANCE_BLOCK_SIZE 64 // side of the square tiles the matrix is stored in
+
+/**
+ * Condensed (upper triangular) float matrix of pairwise distances between N elements.
+ *
+ * The matrix is stored by square tiles of DISTANCE_BLOCK_SIZE x DISTANCE_BLOCK_SIZE
+ * values, so that a whole tile fits in cache. Only tiles above or on the diagonal
+ * are stored.
+ *
+ * The storage never exceeds the given memory budget : the rows of tiles that do not
+ * fit are not stored, and isCached() tells the caller that such distances must be
+ * recomputed on the fly. Since the first rows are the longest ones, distance (i, j)
+ * is available as soon as min(i, j) < cachedRows().
+ */
+class DistanceMatrix {
+public:
+    /** Constructors */
+    DistanceMatrix();
+
+    /**
+     * @param n number of elements
+     * @param memoryBudget maximal size of the stored values, in bytes
+     */
+    DistanceMatrix(unsigned long n, size_t memoryBudget);
+
+    /** Returns the number of elements. */
+    unsigned long size() const;
+
+    /** Returns the number of rows (elements) whose distances are stored. */
+    unsigned long cachedRows() const;
+
+    /** Returns weither the distance between elements i and j is stored or not. */
+    bool isCached(unsigned long i, unsigned long j) const;
+
+    /** Returns the stored distance between elements i and j (asserts that it is cached). */
+    float get(unsigned long i, unsigned long j) const;
+
+    /** Stores the distance between elements i and j (does nothing if not cached). */
+    void set(unsigned long i, unsigned long j, float value);
+
+    /** Returns the memory used by the stored values, in bytes. */
+    size_t bytes() const;
+
+private:
+    // private methods
+
+    /** Index of the (i, j) value in _values, assuming i <= j and i is cached. */
+    size_t index(unsigned long i, unsigned long j) const;
+
+    // private attributes
+    unsigned long _n;
+    unsigned long _nBlocks;          // number of tiles per row/column
+    unsigned long _cachedBlockRows;  // number of rows of tiles that are stored
+    std::vector<size_t> _rowOffsets; // offset of the first tile of each stored row of tiles
+    std::vector<float> _values;
+};
+
+#endif // DISTANCEMATRIX_H
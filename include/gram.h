@@ -0,0 +1,45 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Initial pairwise distances of the linkage from the Gram matrix P.P^T of the
+ * preference matrix : Tanimoto distances only need the inner products of the rows
+ * and their squared norms. */
+
+#ifndef GRAM_H
+#define GRAM_H
+
+#include "anytime.h"
+#include "preference.h"
+#include "distancematrix.h"
+
+/**
+ * Fills the cached part of the distance matrix with the Tanimoto distances of the
+ * rows of the preference matrix.
+ *
+ * The Gram matrix is computed tile by tile, with the tiles of the distance matrix
+ * (DISTANCE_BLOCK_SIZE x DISTANCE_BLOCK_SIZE) : only 1 tile of inner products is
+ * alive per thread, never the whole N x N matrix. The models are split in blocks of
+ * depth columns so that both blocks of rows of a tile stay in cache, and the rows of
+ * the second block are packed model by model so that the inner loop is a vectorized
+ * multiply-add over contiguous values. Zero preference values (most of them) are
+ * skipped.
+ *
+ * Quantized preference values (see precision.h) are accumulated as integers : the
+ * distances are then exactly the ones of PreferenceMatrix::distance(). Floating point
+ * values are accumulated as double, in a different order, so distances may differ in
+ * the last bits.
+ *
+ * @param space the preference functions (1 row per element)
+ * @param distances distance matrix of space.rows() elements
+ * @param depth number of models per block
+ * @param budget checked before each tile : once expired, the remaining tiles are skipped
+ * @return false if the budget expired before all distances were computed
+ */
+bool gramDistances(const PreferenceMatrix &space,
+                   DistanceMatrix &distances,
+                   unsigned long depth = GRAM_BLOCK_DEPTH,
+                   const LinkageBudget &budget = LinkageBudget());
+
+#endif // GRAM_H
@@ -29,6 +29,16 @@ bool loadImage(const std::string &path, cv::Mat &image);
  */
 void contourSobel(cv::Mat &image);
 
+/**
+ * Applies a sobel filter to the given image and keeps the computed
+ * derivatives, so that the orientation of each contour pixel is known.
+ *
+ * @param image
+ * @param gradX output horizontal gradient (CV_32F)
+ * @param gradY output vertical gradient (CV_32F)
+ */
+void contourSobel(cv::Mat &image, cv::Mat &gradX, cv::Mat &gradY);
+
 /**
  * Applies a canny filter to the given image.
  *
@@ -36,6 +46,16 @@ void contourSobel(cv::Mat &image);
  */
 void contourCanny(cv::Mat &image);
 
+/**
+ * Computes the horizontal and vertical intensity gradients of the given image
+ * (blurred with the same kernel as the contour filters).
+ *
+ * @param image input image (color or greyscale), left untouched
+ * @param gradX output horizontal gradient (CV_32F)
+ * @param gradY output vertical gradient (CV_32F)
+ */
+void computeGradients(const cv::Mat &image, cv::Mat &gradX, cv::Mat &gradY);
+
 /**
  * Returns the average greyscale value of a given image.
  *
@@ -52,6 +72,43 @@ unsigned char getAveragePixelValueFrom(const cv::Mat &image);
  */
 PointPool extractPointsFromImage(const cv::Mat &image);
 
+/**
+ * Extracts points from a given contour image, keeping the gradient of each point.
+ *
+ * Contour pixels are scanned row by row in parallel and subsampled with a fixed
+ * stride over the raster order, so the same image always gives the same data set.
+ * Points are directly written into a pre-sized buffer.
+ *
+ * @param image contour image (output of contourCanny or contourSobel)
+ * @param gradX horizontal gradient (CV_32F, see computeGradients), may be empty
+ * @param gradY vertical gradient (CV_32F, see computeGradients), may be empty
+ * @param stride only 1 contour pixel over stride is kept (must be >= 1)
+ * @return the extracted data set
+ */
+PointPool extractPointsFromImage(const cv::Mat &image,
+                                 const cv::Mat &gradX,
+                                 const cv::Mat &gradY,
+                                 int stride = FILTER_VALUE);
+
+/**
+ * Same as above, restricted to a region of the image (tiled mode). Coordinates
+ * are still normalized by the dimensions of the whole image.
+ *
+ * @param image contour image
+ * @param gradX horizontal gradient of the whole image, may be empty
+ * @param gradY vertical gradient of the whole image, may be empty
+ * @param roi the region to extract the points from
+ * @param threshold pixels brighter than this value are contour pixels
+ * @param stride only 1 contour pixel over stride is kept (must be >= 1)
+ * @return the extracted data set
+ */
+PointPool extractPointsFromImage(const cv::Mat &image,
+                                 const cv::Mat &gradX,
+                                 const cv::Mat &gradY,
+                                 const cv::Rect &roi,
+                                 double threshold,
+                                 int stride = FILTER_VALUE);
+
 /**
  * Draws a line on the given image.
  *
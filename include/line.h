@@ -80,9 +80,30 @@ public:
     /** Returns the squared distanc seperating the Line's 2 points. */
     double squaredLength();
 
-    /** Draws and returns n models from the given dataSet. */
+    /**
+     * Draws and returns n models from the given dataSet. Gives up after 10*n draws, so
+     * fewer models are returned if the data set gives fewer distinct lines (ex. all
+     * points on 1 line).
+     */
     static std::vector<Line> drawModels(unsigned int n, const PointPool &dataSet);
 
+    /**
+     * Creates the line going through the given point and orthogonal to its gradient,
+     * i.e. the line tangent to the contour the point was extracted from.
+     * Asserts that the point has gradient information.
+     */
+    static Line fromGradient(const Point &p);
+
+    /**
+     * Draws and returns n models from the given dataSet, using 1 point and its
+     * gradient orientation per model instead of 2 points.
+     *
+     * If refine is true, each hypothesis is refitted on the close points
+     * (within GRADIENT_REFINEMENT_RADIUS) that share the same orientation.
+     * Only points with gradient information are used.
+     */
+    static std::vector<Line> drawModelsFromGradients(unsigned int n, const PointPool &dataSet, bool refine = true);
+
     /**
      * Generates n random inlier points that matches with the line model.
      * Points are generated with noise.
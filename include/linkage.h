@@ -0,0 +1,155 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Agglomeration engine of the T-Linkage and J-Linkage algorithms. */
+
+#ifndef LINKAGE_H
+#define LINKAGE_H
+
+#include <chrono>
+
+#include "anytime.h"
+#include "cluster.h"
+#include "preference.h"
+#include "consensus.h"
+#include "distancematrix.h"
+#include "progress.h"
+
+/**
+ * Agglomerative clustering engine.
+ *
+ * The Space holds 1 row per cluster and defines the distance between 2 rows and how
+ * 2 rows are merged :
+ * - PreferenceMatrix : Tanimoto distance and min of the preference functions (T-Linkage)
+ * - ConsensusMatrix : Jaccard distance and intersection of the consensus sets (J-Linkage)
+ *
+ * Gives the same merges as successive calls to link(), but the preference function
+ * of each cluster is updated on merge instead of being recomputed from its points,
+ * and pairwise distances are cached in a DistanceMatrix that fits in the given memory
+ * budget. Distances that do not fit are recomputed on the fly. Each cluster keeps track
+ * of its nearest neighbour, so that a merge costs O(N.M) instead of O(N^2.M).
+ *
+ * All buffers are allocated by the constructor : members of a cluster are chained
+ * initial clusters and moments are merged in place, so step() never allocates.
+ *
+ * Observers (see progress.h) are notified at most once per interval and once when the
+ * linkage is over or stopped (see finish()). Snapshots are built in a buffer allocated by addObserver().
+ */
+template<typename Space>
+class Linkage {
+public:
+    /**
+     * Constructor.
+     *
+     * @param clusters the initial clusters
+     * @param space the preference functions of the initial clusters (1 row per cluster)
+     * @param memoryBudget maximal size of the distance cache, in bytes
+     * @param budget checked between rows of distances : once expired (deadline or
+     *        cancellation), the setup stops and the engine keeps the initial clusters
+     */
+    Linkage(const std::vector<Cluster> &clusters,
+            const Space &space,
+            size_t memoryBudget = LINKAGE_MEMORY_BUDGET,
+            const LinkageBudget &budget = LinkageBudget());
+
+    /**
+     * Adds an observer of the linkage. The observer must outlive the linkage.
+     *
+     * @param observer the observer
+     * @param interval minimal time between 2 snapshots, in seconds (shared by all observers)
+     */
+    void addObserver(ProgressObserver *observer, double interval = PROGRESS_INTERVAL);
+
+    /**
+     * Links the 2 closest clusters.
+     *
+     * @return false if no clusters could be linked (the linkage is over).
+     */
+    bool step();
+
+    /**
+     * Links clusters until no more clusters can be linked.
+     *
+     * @return the number of linkages.
+     */
+    int run();
+
+    /**
+     * Notifies the observers of the current clustering as the last snapshot, if not
+     * done yet. Called by step() when the linkage is over, call it when the linkage is
+     * stopped before (see anytimeLinkage) so that observers get the final state.
+     */
+    void finish();
+
+    /** Returns the current clusters. */
+    std::vector<Cluster> clusters() const;
+
+    /** Returns the moments of the cluster stored at the given row of the space. */
+    const Moments &moments(unsigned long row) const;
+
+    /** Returns the preference functions of all clusters, including merged ones. */
+    const Space &space() const;
+
+    /** Returns the rows of the space of the current clusters (same order as clusters()). */
+    std::vector<unsigned long> activeRows() const;
+
+    /** Returns the current number of clusters. */
+    unsigned long size() const;
+
+    /** Returns weither the setup was stopped by its budget (step() then links nothing). */
+    bool interrupted() const;
+
+    /** Returns the number of rows of the distance matrix that are cached. */
+    unsigned long cachedRows() const;
+
+    /** Returns the peak memory used by the engine (preferences, distances, neighbours), in bytes. */
+    size_t peakMemory() const;
+
+private:
+    // private methods
+
+    /** Computes the distance between clusters i and j. */
+    float computeDistance(unsigned long i, unsigned long j) const;
+
+    /** Returns the distance between clusters i and j, from cache if available. */
+    float distance(unsigned long i, unsigned long j) const;
+
+    /**
+     * Searches for the nearest neighbour of cluster i among the active clusters.
+     *
+     * @return the number of distances computed (not cached).
+     */
+    unsigned long updateNearest(unsigned long i);
+
+    /** Builds a snapshot and notifies the observers. */
+    void report(bool finished);
+
+    // private attributes
+    std::vector<Cluster> _clusters;       // initial clusters (never modified)
+    std::vector<long> _next;              // next initial cluster of the same cluster (-1 : none)
+    std::vector<long> _last;              // last initial cluster of the chain starting here
+    std::vector<unsigned long> _sizes;    // number of points of each cluster
+    std::vector<Moments> _moments;        // moments of each cluster
+    Space _space;                         // preference function of each cluster
+    DistanceMatrix _distances;            // cached pairwise distances
+    std::vector<char> _active;            // is the cluster still present ?
+    std::vector<long> _nearest;           // nearest neighbour of each cluster (-1 if none)
+    std::vector<float> _nearestDistance;  // distance to the nearest neighbour
+    std::vector<float> _row;              // distances of the last merged cluster
+    unsigned long _size;                  // number of active clusters
+    bool _interrupted;                    // setup stopped by the budget
+    size_t _peakMemory;
+
+    std::vector<ProgressObserver *> _observers;
+    std::chrono::steady_clock::duration _interval;     // minimal time between 2 snapshots
+    std::chrono::steady_clock::time_point _start;      // start of the linkage
+    std::chrono::steady_clock::time_point _lastReport;
+    LinkageProgress _progress;                         // last snapshot
+};
+
+typedef Linkage<PreferenceMatrix> TLinkage;
+typedef Linkage<ConsensusMatrix>  JLinkage;
+
+#endif // LINKAGE_H
@@ -0,0 +1,196 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Approximate T-Linkage for very large data sets : the nearest cluster of a cluster
+ * is only searched among the clusters whose preference functions fall in the same
+ * locality sensitive hashing buckets. */
+
+#ifndef LSH_H
+#define LSH_H
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "anytime.h"
+#include "cluster.h"
+#include "preference.h"
+
+/**
+ * SimHash index of preference functions.
+ *
+ * The signature of a preference function is the sign of its projection on
+ * bands x rows random hyperplanes. Signatures are split in bands of rows bits and
+ * 2 functions are candidates if their signatures are equal on at least 1 band. The
+ * probability of a collision grows with the angle cosine, which Tanimoto similarity
+ * follows closely : more bands give a better recall, more rows per band give smaller
+ * buckets (faster, lower recall).
+ */
+class SimHashIndex {
+public:
+    /** Constructors */
+    SimHashIndex();
+
+    /**
+     * @param cols number of models
+     * @param bands number of bands (max. 64)
+     * @param rows number of bits per band (max. 64)
+     * @param seed seed of the random hyperplanes
+     */
+    SimHashIndex(unsigned long cols, unsigned int bands, unsigned int rows, unsigned int seed = LSH_SEED);
+
+    /** Indexes the given preference function under id (empty functions are not indexed). */
+    void insert(unsigned long id, const PreferenceValue *pf);
+
+    /** Removes id from the index. */
+    void remove(unsigned long id);
+
+    /**
+     * Calls f(candidate) for each indexed id that collides with id on at least 1 band
+     * (id excluded, a candidate may be given several times).
+     */
+    template<typename F>
+    void forEachCandidate(unsigned long id, F f) const {
+        auto it = _keys.find(id);
+        if(it == _keys.end()) {
+            return;
+        }
+        for(unsigned int band = 0; band < _bands; band++) {
+            auto bucket = _buckets[band].find(it->second[band]);
+            for(auto other : bucket->second) {
+                if(other != id) {
+                    f(other);
+                }
+            }
+        }
+    }
+
+    /** Returns the number of indexed ids. */
+    unsigned long size() const;
+
+    /** Returns the memory used by the hyperplanes and the buckets (estimation), in bytes. */
+    size_t bytes() const;
+
+private:
+    // private methods
+
+    /** Computes the band keys of a preference function. */
+    std::vector<uint64_t> signature(const PreferenceValue *pf) const;
+
+    // private attributes
+    unsigned long _cols;
+    unsigned int _bands;
+    unsigned int _rows;
+    std::vector<float> _planes; // hyperplane coefficients, model by model (cols x bands.rows)
+    std::vector<std::unordered_map<uint64_t, std::vector<unsigned long>>> _buckets; // 1 map per band
+    std::unordered_map<unsigned long, std::vector<uint64_t>> _keys; // band keys of each indexed id
+};
+
+/**
+ * Approximate T-Linkage engine, with the same interface as TLinkage (see linkage.h).
+ *
+ * Each cluster keeps track of its nearest neighbour among its LSH candidates only. On
+ * merge, the merged cluster is hashed again, and only its candidates and the clusters
+ * that lost their nearest neighbour compute distances. Merges may differ from the
+ * exact engine when a nearest neighbour is missed by the index.
+ */
+class LshLinkage {
+public:
+    /**
+     * Constructor.
+     *
+     * @param clusters the initial clusters
+     * @param space the preference functions of the initial clusters (1 row per cluster)
+     * @param bands number of LSH bands (recall)
+     * @param rows number of bits per band (speed)
+     * @param budget checked between rows of the setup (see Linkage)
+     */
+    LshLinkage(const std::vector<Cluster> &clusters,
+               const PreferenceMatrix &space,
+               unsigned int bands = LSH_BANDS,
+               unsigned int rows = LSH_ROWS,
+               const LinkageBudget &budget = LinkageBudget());
+
+    /**
+     * Links the 2 closest clusters found by the index.
+     *
+     * @return false if no clusters could be linked (the linkage is over).
+     */
+    bool step();
+
+    /**
+     * Links clusters until no more clusters can be linked.
+     *
+     * @return the number of linkages.
+     */
+    int run();
+
+    /** Same interface as Linkage::finish() : LshLinkage has no observers, does nothing. */
+    void finish();
+
+    /** Returns the current clusters. */
+    std::vector<Cluster> clusters() const;
+
+    /** Returns the preference functions of all clusters, including merged ones. */
+    const PreferenceMatrix &space() const;
+
+    /** Returns the rows of the space of the current clusters (same order as clusters()). */
+    std::vector<unsigned long> activeRows() const;
+
+    /** Returns the current number of clusters. */
+    unsigned long size() const;
+
+    /** Returns weither the setup was stopped by its budget (step() then links nothing). */
+    bool interrupted() const;
+
+    /** Returns the peak memory used by the engine (preferences, index, neighbours), in bytes. */
+    size_t peakMemory() const;
+
+private:
+    // private methods
+
+    /** Searches for the nearest neighbour of cluster i among its candidates. */
+    void updateNearest(unsigned long i);
+
+    // private attributes
+    std::vector<Cluster> _clusters;       // initial clusters (never modified)
+    std::vector<long> _next;              // next initial cluster of the same cluster (-1 : none)
+    std::vector<long> _last;              // last initial cluster of the chain starting here
+    std::vector<unsigned long> _sizes;    // number of points of each cluster
+    PreferenceMatrix _space;              // preference function of each cluster
+    SimHashIndex _index;
+    std::vector<char> _active;            // is the cluster still present ?
+    std::vector<long> _nearest;           // nearest candidate of each cluster (-1 if none)
+    std::vector<float> _nearestDistance;  // distance to the nearest candidate
+    unsigned long _size;                  // number of active clusters
+    bool _interrupted;                    // setup stopped by the budget
+    size_t _peakMemory;
+};
+
+/**
+ * Measures the recall of the index : fraction of the sampled rows whose LSH nearest
+ * neighbour is at the same distance as their exact nearest neighbour.
+ *
+ * @param space the preference functions
+ * @param bands number of LSH bands
+ * @param rows number of bits per band
+ * @param samples number of sampled rows
+ * @return the recall, between 0 and 1
+ */
+double lshRecall(const PreferenceMatrix &space,
+                 unsigned int bands = LSH_BANDS,
+                 unsigned int rows = LSH_ROWS,
+                 unsigned long samples = 1000);
+
+/**
+ * Measures the agreement of 2 clusterings of the same points (for instance LshLinkage
+ * and TLinkage on the same input) : Rand index, fraction of the pairs of points that
+ * are either together in both clusterings or apart in both. Points found in only 1 of
+ * the clusterings are ignored.
+ *
+ * @return the agreement, between 0 and 1
+ */
+double clusteringAgreement(const std::vector<Cluster> &clusters1, const std::vector<Cluster> &clusters2);
+
+#endif // LSH_H
@@ -0,0 +1,100 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Low overhead run metrics : hot path counters and per stage timings, exported
+ * as JSON at the end of a run.
+ *
+ * Metrics are only compiled when TLK_METRICS is defined (cmake -DTLK_METRICS=ON,
+ * default). Otherwise the METRICS_* macros expand to nothing. Counters are meant
+ * to be incremented once per loop (not once per iteration). */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/** Hot path counters. */
+enum class Counter {
+    PF_EVALUATIONS,       // preference function values computed (point x model)
+    DISTANCE_EVALUATIONS, // Tanimoto / Jaccard distances computed
+    PRUNED_PAIRS,         // cluster pairs that a full scan would have compared, but were skipped
+    MERGES,               // linkages
+    BYTES_TOUCHED,        // estimation of the bytes read by the distance computations
+    COUNT
+};
+
+/** Pipeline stages. */
+enum class Stage {
+    LOAD,
+    EDGE_DETECTION,
+    EXTRACTION,
+    SAMPLING,
+    PREFERENCE,
+    LINKAGE,
+    VALIDATION,
+    REFINEMENT,
+    COUNT
+};
+
+/** Global metrics of the run. */
+class Metrics {
+public:
+    /** Increments a counter. */
+    static void add(Counter counter, unsigned long value);
+
+    /** Returns the value of a counter. */
+    static unsigned long get(Counter counter);
+
+    /** Starts timing a stage. */
+    static void startStage(Stage stage);
+
+    /** Stops timing a stage, adding the elapsed time to its total. */
+    static void stopStage(Stage stage);
+
+    /** Returns the total time spent in a stage, in milliseconds. */
+    static double stageTime(Stage stage);
+
+    /** Returns all the metrics (counters, allocations, stage timings) as a JSON object. */
+    static std::string toJson();
+
+    /**
+     * Writes the metrics to the given JSON file.
+     *
+     * @return false if the file could not be written.
+     */
+    static bool writeJson(const std::string &path);
+
+private:
+    static std::atomic<unsigned long> _counters[static_cast<int>(Counter::COUNT)];
+    static std::atomic<long long> _stageNanoseconds[static_cast<int>(Stage::COUNT)];
+    static std::chrono::steady_clock::time_point _stageStarts[static_cast<int>(Stage::COUNT)];
+};
+
+/** Times a stage during its lifetime. */
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage);
+
+    ~StageTimer();
+
+private:
+    Stage _stage;
+};
+
+#ifdef TLK_METRICS
+#define METRICS_COUNT(counter, value) Metrics::add(counter, value)
+#define METRICS_START(stage)          Metrics::startStage(stage)
+#define METRICS_STOP(stage)           Metrics::stopStage(stage)
+#define METRICS_SCOPE(stage)          StageTimer metricsStageTimer(stage)
+#else
+#define METRICS_COUNT(counter, value)
+#define METRICS_START(stage)
+#define METRICS_STOP(stage)
+#define METRICS_SCOPE(stage)
+#endif
+
+#endif // METRICS_H
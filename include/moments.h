@@ -0,0 +1,89 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026 */
+
+#ifndef MOMENTS_H
+#define MOMENTS_H
+
+#include "line.h"
+#include "circle.h"
+
+/**
+ * Running moment sums of a set of points (n, Sx, Sy, Sxx, Sxy, Syy), plus the sums
+ * Sxz, Syz and Szz with z = x^2 + y^2 needed by algebraic circle fitting.
+ * Two sets of moments are combined in O(1), so that the model of a cluster can be
+ * refitted at each merge without walking its points.
+ */
+class Moments {
+public:
+    /** Constructors */
+    Moments();
+
+    explicit Moments(const Point &p);
+
+    /** Adds a point to the set. */
+    void add(const Point &p);
+
+    /** Adds the points of another set. */
+    void merge(const Moments &other);
+
+    /** Returns the number of points. */
+    double n() const;
+
+    /** Returns the centroid of the points. */
+    Point centroid() const;
+
+    /**
+     * Total least squares line fitting : the returned line goes through the centroid,
+     * along the principal axis of the points. Works for any orientation.
+     * Asserts that the set holds at least 2 points.
+     */
+    Line fitLine() const;
+
+    /**
+     * Returns the mean squared orthogonal distance from the points to the line
+     * returned by fitLine().
+     */
+    double lineResidual() const;
+
+    /**
+     * Kasa algebraic circle fitting (linear least squares on x^2 + y^2 + Dx + Ey + F).
+     * Fast but biased towards small circles on short arcs.
+     * Asserts that the set holds at least 3 points.
+     */
+    Circle fitCircleKasa() const;
+
+    /**
+     * Taubin algebraic circle fitting (see N. Chernov, 'Circular and Linear Regression',
+     * 2010). Nearly unbiased, falls back on the Kasa fit if the Newton iterations fail.
+     * Asserts that the set holds at least 3 points.
+     */
+    Circle fitCircle() const;
+
+private:
+    // private methods
+
+    /** Computes the (biased) covariance of the points. */
+    void covariance(double &sxx, double &sxy, double &syy) const;
+
+    /**
+     * Computes the moments of the points centered on their centroid, with
+     * z = x^2 + y^2 (centered coordinates).
+     */
+    void centeredMoments(double &mxx, double &mxy, double &myy,
+                         double &mxz, double &myz, double &mzz) const;
+
+    // private attributes
+    double _n;
+    double _x;
+    double _y;
+    double _xx;
+    double _xy;
+    double _yy;
+    double _xz;
+    double _yz;
+    double _zz;
+};
+
+#endif // MOMENTS_H
@@ -0,0 +1,48 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Coarse-to-fine T-Linkage for large data sets : the linkage runs on a
+ * subsample only, and the remaining points are assigned to the models
+ * fitted on the resulting clusters. */
+
+#ifndef MULTIRESOLUTION_H
+#define MULTIRESOLUTION_H
+
+#include "cluster.h"
+
+/**
+ * Returns a spatially stratified subsample of the given data set.
+ * The [0, 1]x[0, 1] space is split in a grid and each cell gives a number of points
+ * proportional to its population, so that every structure stays represented.
+ * Points are shared with the original pool (no copy).
+ *
+ * @param dataSet the full data set
+ * @param size the wanted size of the subsample
+ * @return the subsample (the whole data set if it is smaller than size)
+ */
+PointPool stratifiedSubsample(const PointPool &dataSet, unsigned int size);
+
+/**
+ * Multiresolution T-Linkage.
+ *
+ * 1. Runs the full T-Linkage on a stratified subsample of the data set.
+ * 2. Fits a line model to each cluster of at least MULTIRES_MIN_CLUSTER_SIZE points.
+ * 3. Assigns every other point to its closest model (in parallel), or to the outliers.
+ * 4. Re-links the ambiguous points (close to several models) with the Tanimoto distance
+ *    between their preference function and the one of the candidate clusters.
+ *
+ * Outliers are returned as singleton clusters, so that the usual validation
+ * functions can be applied to the result.
+ *
+ * @param dataSet the full data set
+ * @param models the sampled models
+ * @param subsampleSize the number of points used for the linkage itself
+ * @return the clusters of the full data set
+ */
+std::vector<Cluster> multiresolutionLinkage(PointPool &dataSet,
+                                            const std::vector<Line> &models,
+                                            unsigned int subsampleSize = MULTIRES_SUBSAMPLE_SIZE);
+
+#endif // MULTIRESOLUTION_H
@@ -37,11 +37,21 @@ public:
     Point(const Point& p)
         : _x { p._x }
         , _y { p._y }
+        , _gradientMagnitude { p._gradientMagnitude }
+        , _gradientOrientation { p._gradientOrientation }
     {}
 
     /** Constructor */
     Point(double x, double y);
 
+    /**
+     * Constructor for points extracted from an image.
+     *
+     * @param gradientMagnitude intensity gradient magnitude at the point (pixel units)
+     * @param gradientOrientation gradient direction (radians) expressed in the [0, 1]x[0, 1] frame
+     */
+    Point(double x, double y, double gradientMagnitude, double gradientOrientation);
+
     /** Destructor */
     ~Point();
 
@@ -89,6 +99,15 @@ public:
 
     bool isInlier() const;
 
+    /** Accessor for private _gradientMagnitude field. */
+    double gradientMagnitude() const;
+
+    /** Accessor for private _gradientOrientation field. */
+    double gradientOrientation() const;
+
+    /** Returns weither the point carries gradient information or not. */
+    bool hasGradient() const;
+
 
     /** Factory method for random point generation. */
     static Point randomlyGenerated();
@@ -202,6 +221,10 @@ private:
 
     // temporary space to store bext match value for a point
     double _bestMatchValue = 0.;
+
+    // image gradient at the point (0 if the point does not come from an image)
+    double _gradientMagnitude = 0.;
+    double _gradientOrientation = 0.;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////
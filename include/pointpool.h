@@ -8,6 +8,12 @@
 
 #include "point.h"
 
+/** Space filling curves used to sort the points (see PointPool::sortAlongCurve). */
+enum class SpaceFillingCurve {
+    MORTON,  // Z-order : bit interleaving, cheapest
+    HILBERT  // no jumps between consecutive cells, best locality
+};
+
 /**
  * Represents a set of unique Point objects. To be used once in the progam.
  */
@@ -16,6 +22,12 @@ public:
     /** Constructor */
     PointPool();
 
+    /**
+     * Builds a pool directly from an already filled point buffer.
+     * Points are assumed to be unique, no check is done.
+     */
+    PointPool(std::vector<std::shared_ptr<Point>> &&points);
+
     /**
      * Factory method to generate n random points, returned as an immutable set.
      *
@@ -70,9 +82,28 @@ public:
      /** Returns an iterator to the end (shared pointer). */
      std::vector<std::shared_ptr<Point>>::iterator end();
 
+    /**
+     * Sorts the points along a space filling curve, so that close points are close in
+     * the pool and in memory : every point is copied in a new allocation, in the new
+     * order. Must be called before the points are shared (clusters, subsamples...).
+     *
+     * @param curve the curve to follow
+     * @return for each new index, the index of the point before the first sorting
+     */
+    const std::vector<unsigned long> &sortAlongCurve(SpaceFillingCurve curve = SpaceFillingCurve::HILBERT);
+
+    /**
+     * Returns the index that the pos-th point had before the first sorting. Points
+     * inserted after it get new indices, never used by another point (removed ones
+     * included).
+     */
+    unsigned long originalIndex(unsigned long pos) const;
+
 private:
     // private attributes
    std::vector<std::shared_ptr<Point>> _points;
+   std::vector<unsigned long> _originalIndices; // empty until the pool is sorted
+   unsigned long _nextOriginalIndex = 0;        // original index of the next inserted point, once sorted
 };
 
 #endif // POINTPOOL_H
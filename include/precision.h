@@ -0,0 +1,159 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Storage precision of the preference functions (see PreferenceMatrix), chosen at
+ * compile time with PREFERENCE_PRECISION. Preference values live in [0, 1], so they
+ * can be stored as floats or quantized to 16 or 8 bits, dividing the memory and the
+ * bandwidth of the distance computations by 2 to 8. */
+
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "settings.h"
+
+#define PRECISION_DOUBLE 0
+#define PRECISION_FLOAT  1
+#define PRECISION_UINT16 2
+#define PRECISION_UINT8  3
+
+/**
+ * Precision policy : how a preference value in [0, 1] is stored and read back.
+ */
+template<typename T>
+struct Precision;
+
+template<>
+struct Precision<double> {
+    typedef double value_type;
+
+    static value_type store(double value) {
+        return value;
+    }
+
+    static double load(value_type value) {
+        return value;
+    }
+};
+
+template<>
+struct Precision<float> {
+    typedef float value_type;
+
+    static value_type store(double value) {
+        return value;
+    }
+
+    static double load(value_type value) {
+        return value;
+    }
+};
+
+/**
+ * Fixed point quantization of [0, 1] on the full range of an unsigned integer type.
+ * Positive values never round to 0, so that consensus sets (PF > 0) do not depend on
+ * the precision.
+ */
+template<typename T>
+struct QuantizedPrecision {
+    typedef T value_type;
+    static constexpr double scale = static_cast<T>(~T(0));
+
+    static value_type store(double value) {
+        if(value <= 0.) {
+            return 0;
+        }
+        return static_cast<T>(std::max(1., std::min(scale, std::round(value*scale))));
+    }
+
+    static double load(value_type value) {
+        return value/scale;
+    }
+};
+
+template<>
+struct Precision<uint16_t> : QuantizedPrecision<uint16_t> {};
+
+template<>
+struct Precision<uint8_t> : QuantizedPrecision<uint8_t> {};
+
+#if PREFERENCE_PRECISION == PRECISION_FLOAT
+typedef float PreferenceValue;
+#elif PREFERENCE_PRECISION == PRECISION_UINT16
+typedef uint16_t PreferenceValue;
+#elif PREFERENCE_PRECISION == PRECISION_UINT8
+typedef uint8_t PreferenceValue;
+#else
+typedef double PreferenceValue;
+#endif
+
+typedef Precision<PreferenceValue> PreferencePrecision;
+
+/** Tanimoto distance from the sums a.a, b.b and a.b (any common scale). */
+template<typename Sum>
+inline double tanimotoFromSums(Sum aa, Sum bb, Sum ab) {
+    // 2 empty preference functions have nothing in common
+    if(aa + bb - ab <= 0) {
+        return 1.;
+    }
+    return 1 - static_cast<double>(ab)/static_cast<double>(aa + bb - ab);
+}
+
+/**
+ * Tanimoto distance of 2 stored preference functions (the double version is declared
+ * in cluster.h). The distance does not depend on the scale of the values, so quantized
+ * values are used as they are : integer dot products, exact and vectorized.
+ */
+inline double tanimoto(const float *a, const float *b, unsigned long size) {
+    float aa = 0.f, bb = 0.f, ab = 0.f;
+
+    #pragma omp simd reduction(+:aa, bb, ab)
+    for(unsigned long i = 0; i < size; i++) {
+        aa += a[i]*a[i];
+        bb += b[i]*b[i];
+        ab += a[i]*b[i];
+    }
+    return tanimotoFromSums<double>(aa, bb, ab);
+}
+
+inline double tanimoto(const uint16_t *a, const uint16_t *b, unsigned long size) {
+    uint64_t aa = 0, bb = 0, ab = 0;
+
+    #pragma omp simd reduction(+:aa, bb, ab)
+    for(unsigned long i = 0; i < size; i++) {
+        aa += uint32_t(a[i])*a[i];
+        bb += uint32_t(b[i])*b[i];
+        ab += uint32_t(a[i])*b[i];
+    }
+    return tanimotoFromSums<int64_t>(aa, bb, ab);
+}
+
+inline double tanimoto(const uint8_t *a, const uint8_t *b, unsigned long size) {
+    // 255^2 * 2^16 < 2^32 : 32 bits sums for up to 65536 models (twice as many lanes)
+    if(size <= (1UL << 16)) {
+        uint32_t aa = 0, bb = 0, ab = 0;
+
+        #pragma omp simd reduction(+:aa, bb, ab)
+        for(unsigned long i = 0; i < size; i++) {
+            aa += uint16_t(a[i])*a[i];
+            bb += uint16_t(b[i])*b[i];
+            ab += uint16_t(a[i])*b[i];
+        }
+        return tanimotoFromSums<int64_t>(aa, bb, ab);
+    }
+
+    uint64_t aa = 0, bb = 0, ab = 0;
+    for(unsigned long i = 0; i < size; i++) {
+        aa += uint32_t(a[i])*a[i];
+        bb += uint32_t(b[i])*b[i];
+        ab += uint32_t(a[i])*b[i];
+    }
+    return tanimotoFromSums<int64_t>(aa, bb, ab);
+}
+
+#endif // PRECISION_H
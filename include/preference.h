@@ -0,0 +1,103 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026 */
+
+#ifndef PREFERENCE_H
+#define PREFERENCE_H
+
+#include <vector>
+
+#include "line.h"
+#include "circle.h"
+#include "precision.h"
+
+class Cluster;
+
+/** Family of models (mixed model mode). */
+enum class ModelFamily {
+    NONE,   // the element matches with no model
+    LINE,
+    CIRCLE
+};
+
+/**
+ * Dense preference matrix : the i-th row is the preference function of the
+ * i-th element (point or cluster), the j-th column corresponds to the j-th model.
+ * Rows are stored contiguously, as PreferenceValue (see precision.h) : values must
+ * be written with PreferencePrecision::store() and read with PreferencePrecision::load().
+ */
+class PreferenceMatrix {
+public:
+    /** Constructors */
+    PreferenceMatrix();
+
+    PreferenceMatrix(unsigned long rows, unsigned long cols);
+
+    /**
+     * Factory method that computes the preference function of each point of the data set.
+     */
+    static PreferenceMatrix build(const PointPool &dataSet, const std::vector<Line> &models);
+
+    /** Same as above, for circle models. */
+    static PreferenceMatrix build(const PointPool &dataSet, const std::vector<Circle> &models);
+
+    /**
+     * Factory method that computes the preference function of each cluster, i.e. the
+     * minimum of the preference functions of its points (see Cluster::computePF).
+     */
+    static PreferenceMatrix build(const std::vector<Cluster> &clusters, const std::vector<Line> &models);
+
+    /** Same as above, for circle models. */
+    static PreferenceMatrix build(const std::vector<Cluster> &clusters, const std::vector<Circle> &models);
+
+    /**
+     * Factory method for the mixed model mode : line and circle models share the same
+     * preference space. The first columns correspond to the line models, the following
+     * ones to the circle models. Both families are computed in a single pass over the points.
+     */
+    static PreferenceMatrix build(const PointPool &dataSet,
+                                  const std::vector<Line> &lines,
+                                  const std::vector<Circle> &circles);
+
+    /** Same as above, for clusters. */
+    static PreferenceMatrix build(const std::vector<Cluster> &clusters,
+                                  const std::vector<Line> &lines,
+                                  const std::vector<Circle> &circles);
+
+    /** Returns the number of rows (points or clusters). */
+    unsigned long rows() const;
+
+    /** Returns the number of columns (models). */
+    unsigned long cols() const;
+
+    /** Returns a pointer to the first value of the i-th row. */
+    PreferenceValue *row(unsigned long i);
+
+    /** Returns a pointer to the first value of the i-th row. */
+    const PreferenceValue *row(unsigned long i) const;
+
+    /** Returns the Tanimoto distance between the preference functions of elements i and j. */
+    double distance(unsigned long i, unsigned long j) const;
+
+    /** Replaces the preference function of element i by its minimum with the one of element j. */
+    void merge(unsigned long i, unsigned long j);
+
+    /**
+     * Returns the family of the model that the i-th element prefers, assuming the
+     * first nLines columns are line models and the other ones circle models.
+     * Lines win ties with circles.
+     */
+    ModelFamily bestFamily(unsigned long i, unsigned long nLines) const;
+
+    /** Returns the memory used by the values, in bytes. */
+    size_t bytes() const;
+
+private:
+    // private attributes
+    unsigned long _rows;
+    unsigned long _cols;
+    std::vector<PreferenceValue> _values;
+};
+
+#endif // PREFERENCE_H
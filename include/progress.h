@@ -0,0 +1,51 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Progress reporting of the linkage : observers are given snapshots of the current
+ * clustering at a throttled rate, so that logging and display do not slow it down. */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <vector>
+
+#include "settings.h"
+
+/**
+ * Snapshot of a running linkage.
+ *
+ * Clusters are identified by a row of the linkage space : labels[i] is the row of the
+ * cluster the i-th initial cluster currently belongs to (labels[i] == i for the rows of
+ * the current clusters).
+ */
+struct LinkageProgress {
+    unsigned long merges = 0;   // merges so far
+    unsigned long clusters = 0; // current number of clusters
+    float distance = 0.f;       // distance of the last merge
+    double seconds = 0.;        // time since the start of the linkage
+    bool finished = false;      // true for the last snapshot (linkage over or stopped)
+    std::vector<long> labels;
+};
+
+/**
+ * Receives the snapshots of a linkage (see Linkage::addObserver).
+ *
+ * notify() is called by the linkage itself, between 2 merges : it must return quickly
+ * and copy what it needs, the snapshot is overwritten by the next one.
+ */
+class ProgressObserver {
+public:
+    virtual ~ProgressObserver() {}
+
+    virtual void notify(const LinkageProgress &progress) = 0;
+};
+
+/** Logs 1 line per snapshot. */
+class ProgressLogger : public ProgressObserver {
+public:
+    void notify(const LinkageProgress &progress) override;
+};
+
+#endif // PROGRESS_H
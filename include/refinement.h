@@ -0,0 +1,48 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Post-linkage refinement : models of the validated clusters are refitted and
+ * every point is reassigned to its closest model. */
+
+#ifndef REFINEMENT_H
+#define REFINEMENT_H
+
+#include "cluster.h"
+
+/**
+ * Refines the validated clusters with line models.
+ *
+ * Each iteration fits a line to each validated cluster (total least squares) and
+ * reassigns every point of the given clusters to its closest line, if closer than
+ * the threshold. Other points become outliers. Stops when no point changes of
+ * cluster, or after the given number of iterations.
+ *
+ * Points are processed in parallel, and residuals are computed for all points at once
+ * for each model (vectorized).
+ *
+ * @param clusters all the clusters (validated or not) after linkage and validation
+ * @param iterations max. number of iterations
+ * @param threshold max. distance from a point to its model
+ * @return the refined clusters (validated), followed by the outliers (singletons, rejected)
+ */
+std::vector<Cluster> refineLineModels(const std::vector<Cluster> &clusters,
+                                      int iterations = REFINEMENT_ITERATIONS,
+                                      double threshold = 5*TAU);
+
+/** Same as above, with circle models (Taubin fit). */
+std::vector<Cluster> refineCircleModels(const std::vector<Cluster> &clusters,
+                                        int iterations = REFINEMENT_ITERATIONS,
+                                        double threshold = 5*TAU);
+
+/**
+ * Same as above, each cluster with the model of its family (see Cluster::family()) :
+ * circle models for the clusters labelled as circles, line models for the other ones.
+ * Refined clusters keep their label.
+ */
+std::vector<Cluster> refineMixedModels(const std::vector<Cluster> &clusters,
+                                       int iterations = REFINEMENT_ITERATIONS,
+                                       double threshold = 5*TAU);
+
+#endif // REFINEMENT_H
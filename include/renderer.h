@@ -0,0 +1,99 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Live display of a running linkage, drawn on a separate thread. */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "cluster.h"
+#include "progress.h"
+
+enum class RenderMode {
+    WINDOW, // Imagine++ window
+    PNG     // offscreen, 1 image per snapshot written with OpenCV
+};
+
+/**
+ * Draws the snapshots of a linkage, each cluster with its own color.
+ *
+ * notify() only copies the snapshot and wakes the drawing thread up : the linkage never
+ * waits for a frame to be drawn. If the linkage is faster than the display, snapshots
+ * that were not drawn yet are replaced by newer ones (only the last one is kept), but
+ * the final snapshot is always drawn.
+ *
+ * In WINDOW mode, the renderer opens its own window. Imagine++ forwards drawing calls to
+ * its GUI thread, so the window may be drawn from any thread, but it must not be used by
+ * another thread before finish().
+ *
+ * In PNG mode, snapshots are written to prefix0000.png, prefix0001.png, ...
+ */
+class AsyncRenderer : public ProgressObserver {
+public:
+    /**
+     * Constructor, starts the drawing thread.
+     *
+     * @param clusters the initial clusters of the linkage (same order as its rows)
+     * @param windowWidth width of the window or images
+     * @param windowHeight height of the window or images
+     * @param mode where snapshots are drawn
+     * @param prefix path prefix of the images (PNG mode)
+     */
+    AsyncRenderer(const std::vector<Cluster> &clusters,
+                  int windowWidth,
+                  int windowHeight,
+                  RenderMode mode = RenderMode::WINDOW,
+                  const std::string &prefix = PROGRESS_FILE_PREFIX);
+
+    /** Destructor, see finish(). */
+    ~AsyncRenderer();
+
+    AsyncRenderer(const AsyncRenderer &) = delete;
+    AsyncRenderer &operator=(const AsyncRenderer &) = delete;
+
+    /** Hands a snapshot to the drawing thread. */
+    void notify(const LinkageProgress &progress) override;
+
+    /** Draws the pending snapshot, if any, and stops the drawing thread. */
+    void finish();
+
+    /** Returns the number of drawn snapshots. */
+    unsigned long frames() const;
+
+private:
+    // private methods
+
+    /** Drawing thread. */
+    void loop();
+
+    /** Draws a snapshot in the window. */
+    void drawWindow(const LinkageProgress &progress);
+
+    /** Draws a snapshot in a new image. */
+    void drawImage(const LinkageProgress &progress);
+
+    // private attributes
+    std::vector<Cluster> _clusters;
+    int _windowWidth;
+    int _windowHeight;
+    RenderMode _mode;
+    std::string _prefix;
+    unsigned long _frames;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    LinkageProgress _pending; // last snapshot handed by the linkage
+    LinkageProgress _drawn;   // snapshot being drawn (swapped with _pending)
+    bool _hasPending;
+    bool _stop;
+    std::thread _thread;
+};
+
+#endif // RENDERER_H
@@ -0,0 +1,108 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Adaptive model sampling : models are drawn until the data set is
+ * covered, instead of drawing a fixed number of models. */
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <iostream>
+#include <vector>
+
+#include "pointpool.h"
+#include "settings.h"
+#include "trace.h"
+
+/**
+ * Draws models batch by batch until the preference of the data set is stable.
+ *
+ * After each batch, we measure the coverage (fraction of points that match with
+ * at least 1 model) and the mean best preference value of the points. Sampling
+ * stops as soon as none of them improved by more than tolerance, as long as
+ * minModels were drawn. No more than maxModels are drawn.
+ *
+ * Model must provide PFValue(const Point &) and operator==.
+ *
+ * @param dataSet the data set
+ * @param drawBatch callable such that drawBatch(n) returns n new models (ex. Line::drawModels)
+ * @param minModels minimal number of models
+ * @param maxModels maximal number of models
+ * @param tolerance minimal improvement for the sampling to go on
+ * @return the drawn models
+ */
+template<typename Model, typename DrawBatch>
+std::vector<Model> drawModelsAdaptive(const PointPool &dataSet,
+                                      DrawBatch drawBatch,
+                                      unsigned int minModels = MIN_MODELS_TO_DRAW,
+                                      unsigned int maxModels = MAX_MODELS_TO_DRAW,
+                                      double tolerance = SAMPLING_TOLERANCE) {
+    TRACE_SCOPE("sampling");
+    assert(minModels <= maxModels);
+
+    std::vector<Model> models;
+    std::vector<double> bestPF(dataSet.size(), 0.); // best preference of each point so far
+
+    double coverage = 0.;
+    double meanBestPF = 0.;
+    unsigned int emptyBatches = 0;
+
+    while(models.size() < maxModels) {
+        auto batchSize = std::min<unsigned int>(SAMPLING_BATCH_SIZE, maxModels - models.size());
+        auto first = models.size();
+
+        for(auto &model : drawBatch(batchSize)) {
+            auto insert = true;
+            for(const auto &other : models) {
+                if(model == other) {
+                    insert = false;
+                    break;
+                }
+            }
+            if(insert) {
+                models.emplace_back(model);
+            }
+        }
+
+        // the sampler only gives already known models
+        if(models.size() == first) {
+            if(++emptyBatches >= 3) {
+                break;
+            }
+            continue;
+        }
+        emptyBatches = 0;
+
+        // update best preference values with the new models only
+        long covered = 0;
+        double sum = 0.;
+
+        #pragma omp parallel for reduction(+:covered, sum)
+        for(long i = 0; i < static_cast<long>(dataSet.size()); i++) {
+            for(auto m = first; m < models.size(); m++) {
+                bestPF[i] = std::max(bestPF[i], models[m].PFValue(*dataSet[i]));
+            }
+            covered += bestPF[i] > 0.;
+            sum += bestPF[i];
+        }
+
+        auto newCoverage = static_cast<double>(covered)/dataSet.size();
+        auto newMeanBestPF = sum/dataSet.size();
+        auto improved = newCoverage - coverage > tolerance || newMeanBestPF - meanBestPF > tolerance;
+
+        coverage = newCoverage;
+        meanBestPF = newMeanBestPF;
+
+        if(!improved && models.size() >= minModels) {
+            break;
+        }
+    }
+
+    std::cout << "[DEBUG] End of adaptive sampling. Kept " << models.size()
+              << " models (coverage : " << coverage << ", mean best PF : " << meanBestPF << ")" << std::endl;
+    return models;
+}
+
+#endif // SAMPLING_H
@@ -0,0 +1,86 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Gaussian scale space : the successive blurs of an image are computed once,
+ * each level from the previous one, and DoGs, edge maps and points of any scale
+ * are derived from them. */
+
+#ifndef SCALESPACE_H
+#define SCALESPACE_H
+
+#include "image.h"
+
+/**
+ * Gaussian pyramid (same resolution at every level).
+ *
+ * Level l is the image blurred with the kernel of size 2l+1 that dog() and
+ * successiveDoG() use (level 0 is the image itself). Since the blur of a blur is a
+ * blur (variances add up), level l+1 is computed from level l with a small kernel
+ * of standard deviation sqrt(sigma(l+1)^2 - sigma(l)^2) : 1 small blur per level
+ * instead of 2 full blurs of the original image.
+ *
+ * Levels are stored as CV_32F, so that rounding errors do not add up.
+ */
+class ScaleSpace {
+public:
+    /** Constructors */
+    ScaleSpace();
+
+    /**
+     * @param image the original image (any type, grey or color)
+     * @param levels number of levels (>= 1)
+     */
+    ScaleSpace(const cv::Mat &image, int levels);
+
+    /**
+     * Returns the standard deviation of the kernel OpenCV uses for the given (odd)
+     * size : the one of its fixed tables up to size 7, then 0.3*((size - 1)*0.5 - 1) + 0.8.
+     */
+    static double kernelSigma(int kernelSize);
+
+    /** Returns the number of levels. */
+    int levels() const;
+
+    /** Returns the standard deviation of the blur of the given level. */
+    double sigma(int level) const;
+
+    /** Returns the given level (CV_32F). */
+    const cv::Mat &level(int level) const;
+
+    /**
+     * Returns level(l) - level(l+1), with the type of the original image : same
+     * result as dog(image, 2l+1, 2l+3).
+     */
+    cv::Mat dog(int level) const;
+
+    /**
+     * Returns the edge map of the given level, in the format of contourCanny
+     * (grey values of the contour pixels, black elsewhere).
+     */
+    cv::Mat edges(int level) const;
+
+    /** Returns the edge maps of all levels. */
+    std::vector<cv::Mat> edgeMaps() const;
+
+    /**
+     * Extracts the points of the given level (see extractPointsFromImage), with
+     * the gradient of that level.
+     */
+    PointPool extractPoints(int level, int stride = FILTER_VALUE) const;
+
+    /**
+     * Extracts the points of all levels. A pixel that is a contour pixel at several
+     * scales only gives 1 point, from the finest of them.
+     */
+    PointPool extractPointsAcrossScales(int stride = FILTER_VALUE) const;
+
+private:
+    // private attributes
+    int _type;                   // type of the original image
+    std::vector<double> _sigmas; // blur of each level
+    std::vector<cv::Mat> _levels;
+};
+
+#endif // SCALESPACE_H
@@ -12,6 +12,58 @@
 #define Z             1          // normalization constant (in fact, we can keep it to 1)
 #define SQUARED_SIGMA 0.001      // for random sampling (default : 0.001
 #define N_MODELS_TO_DRAW 50
+#define COMPACTION_MIN_CONSENSUS   3   // models with less inliers are dropped before the linkage
+#define COMPACTION_SIMILARITY      0.99 // models whose consensus sets have a greater Jaccard index are merged
+                                        // (duplicates also vote for their structure : lower values cost accuracy)
+#define COMPACTION_PREEMPTIVE_SIZE 0   // points of the preemptive scoring subset (0 : no preemptive scoring)
+#define PREFERENCE_QUANTIZATION 0    // 0 : only points with identical PF values start in the same cluster
+                                     // > 0 : PF values equal once rounded to 1/PREFERENCE_QUANTIZATION (merges
+                                     //       the linkage did not choose, they can not be undone)
+#define PREFERENCE_PRECISION 0   // storage of the preference values : 0 double, 1 float, 2 uint16, 3 uint8
+                                 // (see precision.h)
+
+#define J_LINKAGE     0          // 1 : link with J-Linkage (binary consensus sets) instead of T-Linkage
+#define CIRCLE_REFINEMENT_ITERATIONS 10 // max. Gauss-Newton iterations of the geometric circle fitting
+#define REFINEMENT_ITERATIONS 5  // max. refit/reassign iterations after the linkage (0 : no refinement)
+#define MIXED_MODELS  0          // 1 : line and circle models are linked together (demo)
+#define MIXED_LINE_TOLERANCE 0.9 // a line wins if its PF is at least this fraction of the best circle's
+#define TAU_SWEEP     0          // 1 : the demo links the data set for each TAU_SWEEP_VALUES and prints a summary
+#define TAU_SWEEP_VALUES {0.0025, 0.005, 0.0075, 0.01, 0.02}
+#define LINKAGE_MEMORY_BUDGET (512UL << 20) // max. size (bytes) of the pairwise distance cache of the linkage
+#define GRAM_INITIALISATION 1    // 1 : the distance cache of T-Linkage is filled from the Gram matrix (see gram.h)
+#define GRAM_BLOCK_DEPTH 256     // models per block of the Gram matrix kernel
+#define LINKAGE_DEADLINE 0       // max. duration (s) of the linkage, setup included (0 : none, see anytime.h)
+#define LINKAGE_MAX_MERGES 0     // max. number of merges of the linkage (0 : none)
+#define SHARDED_LINKAGE 0        // 1 : T-Linkage split between worker processes (see sharding.h), without
+                                 //     deadline nor progress display (ignored with J_LINKAGE or LSH_LINKAGE)
+#define LINKAGE_WORKERS 4        // worker processes of the sharded linkage (see sharding.h)
+#define LSH_LINKAGE   0          // 1 : approximate linkage, nearest clusters searched in LSH buckets (see lsh.h)
+#define LSH_BANDS     16         // more bands : better recall
+#define LSH_ROWS      8          // more bits per band : smaller buckets, faster
+#define LSH_SEED      42         // seed of the LSH hyperplanes
+#define LSH_AGREEMENT 0          // 1 : the demo also runs the exact T-Linkage (O(N^2) time and memory) to report
+                                 //     the agreement of both clusterings (check only, lshRecall is cheaper)
+#define SPATIAL_ORDER 1          // 1 : points are sorted along a Hilbert curve before clustering (cache locality)
+#define PROGRESS_MODE 0          // live linkage display : 0 none, 1 window, 2 PNG images (see renderer.h)
+#define PROGRESS_INTERVAL 0.1    // min. time (s) between 2 snapshots of the linkage
+#define PROGRESS_FILE_PREFIX "linkage_" // images of the PNG mode : linkage_0000.png, ...
+#define METRICS_FILE  "metrics.json" // run metrics output (TLK_METRICS builds only)
+#define TRACE_FILE    "trace.json"   // chrome trace output (TLK_TRACE builds only)
+#define TRACE_BUFFER_SIZE (1UL << 18) // max. trace events per thread
+
+// adaptive sampling (see sampling.h)
+#define MIN_MODELS_TO_DRAW  20   // sampling never stops before this number of models
+#define MAX_MODELS_TO_DRAW  500  // sampling always stops at this number of models
+#define SAMPLING_BATCH_SIZE 10   // models drawn between 2 coverage checks
+#define SAMPLING_TOLERANCE  0.01 // sampling stops when coverage improves less than this value
+
+// multiresolution linkage (see multiresolution.h)
+#define MULTIRESOLUTION_LINKAGE   0   // 1 : the demo links a subsample and assigns the other points (line models
+                                      //     only, replaces the other linkage modes)
+#define MULTIRES_SUBSAMPLE_SIZE   300 // number of points the linkage actually runs on
+#define MULTIRES_MIN_CLUSTER_SIZE 5   // smaller coarse clusters do not give a model
+#define MULTIRES_AMBIGUITY_MARGIN 0.5 // a point is ambiguous if its 2 closest models are closer than
+                                      // this fraction of the inlier threshold from each other
 
 ////////////////////////////////////////////////////////////////////
 
@@ -41,8 +93,19 @@
 #define DEFAULT_IMAGE "shapes.jpg" // image to load from the input folder
 #define CANNY_THRESHOLD_1 100 // default : 100
 #define CANNy_THRESHOLD_2 3*CANNY_THRESHOLD_1
-#define FILTER_VALUE  10        // must be > 1 (the more the value gets the less points will be kept)
+#define EDGE_THRESHOLD_FACTOR 3 // pixels brighter than this factor times the image mean are contour pixels
+#define FILTER_VALUE  10        // must be >= 1 (1 contour pixel over FILTER_VALUE is kept, in raster order)
                                 //     (default : 10)
+#define SCALE_SPACE_LEVELS 4    // levels of the multi-scale extraction (see scalespace.h)
+#define TILED_MODE    0         // 1 : the image is processed in tiles (see tiling.h)
+#define TILE_SIZE     256       // size (pixels) of the core region of a tile
+#define TILE_OVERLAP  32        // pixels added on each side of a tile, where clusters are stitched
+#define TILE_MIN_CLUSTER_SIZE 10   // smaller tile clusters are not stitched
+#define TILE_ANGLE_TOLERANCE  0.1  // max. sine of the angle between 2 stitched lines
+#define TILE_AGREEMENT        0.5  // min. fraction of overlap points that must fit the other line
+#define GRADIENT_REFINEMENT_RADIUS 0.02 // neighbourhood used to refine single point line models
+#define GRADIENT_ANGLE_TOLERANCE   0.2  // max. orientation difference (radians) for a point to be
+                                        // used in the refinement of a single point line model
 #define ROUND_VALUE   10000.          // must be > 0.
                                    // The bigger this value gets, the more accurate the data set will be generated.
                                    // The more close to 0 the value gets, the more pixelated the dataset will be generated.
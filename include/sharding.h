@@ -0,0 +1,43 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Multi-process T-Linkage : the clusters are split between local worker processes
+ * that share the preference matrix through POSIX shared memory. */
+
+#ifndef SHARDING_H
+#define SHARDING_H
+
+#include "cluster.h"
+#include "preference.h"
+
+/**
+ * Sharded T-Linkage over worker processes (POSIX systems only).
+ *
+ * Each worker owns a contiguous slice of the rows : it writes their preference
+ * functions in the shared segment (first touch, so that the pages of a slice live
+ * on the NUMA node of its worker) and keeps track of their nearest neighbours in
+ * its own memory. Every round :
+ * 1. each worker publishes its best candidate pair,
+ * 2. the coordinator (calling process) picks the closest pair, with the same
+ *    tie-breaking as Linkage::step(), and records the merge,
+ * 3. the owner of the merged row updates its preference function,
+ * 4. every worker computes the distances of its rows to the merged cluster and
+ *    updates their nearest neighbours.
+ *
+ * Merges are the same as the ones of TLinkage, so the result is the same.
+ * Falls back to TLinkage if workers < 2, if the shared segment or the processes
+ * could not be created, or if a worker dies : the barriers poll the workers, which
+ * are killed, and the linkage is run again in the calling process.
+ *
+ * @param clusters the initial clusters
+ * @param preferences the preference functions of the initial clusters (1 row per cluster)
+ * @param workers number of worker processes
+ * @return the clusters, in the same order as TLinkage::clusters()
+ */
+std::vector<Cluster> shardedLinkage(const std::vector<Cluster> &clusters,
+                                    const PreferenceMatrix &preferences,
+                                    int workers = LINKAGE_WORKERS);
+
+#endif // SHARDING_H
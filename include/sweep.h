@@ -0,0 +1,92 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * TAU sweep : point to model residuals do not depend on TAU, so they are computed
+ * once and every tried value only derives its preference matrix from them
+ * (PF = exp(-r/TAU) if r < 5*TAU, 0 otherwise) before running its own linkage. */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <iostream>
+#include <vector>
+
+#include "cluster.h"
+#include "preference.h"
+
+/**
+ * Dense residual matrix : the i-th row holds the distances from the i-th point
+ * of the data set to every model. Rows are stored contiguously.
+ */
+class ResidualMatrix {
+public:
+    /** Constructors */
+    ResidualMatrix();
+
+    ResidualMatrix(unsigned long rows, unsigned long cols);
+
+    /** Factory method that computes the residuals of each point of the data set. */
+    static ResidualMatrix build(const PointPool &dataSet, const std::vector<Line> &models);
+
+    /** Same as above, for circle models. */
+    static ResidualMatrix build(const PointPool &dataSet, const std::vector<Circle> &models);
+
+    /** Returns the number of rows (points). */
+    unsigned long rows() const;
+
+    /** Returns the number of columns (models). */
+    unsigned long cols() const;
+
+    /** Returns a pointer to the first value of the i-th row. */
+    double *row(unsigned long i);
+
+    /** Returns a pointer to the first value of the i-th row. */
+    const double *row(unsigned long i) const;
+
+    /**
+     * Returns the preference matrix of the points for the given TAU, the same one
+     * as PreferenceMatrix::build(dataSet, models) with TAU = tau.
+     */
+    PreferenceMatrix preferences(double tau) const;
+
+    /** Returns the memory used by the values, in bytes. */
+    size_t bytes() const;
+
+private:
+    // private attributes
+    unsigned long _rows;
+    unsigned long _cols;
+    std::vector<double> _values;
+};
+
+/** Outcome of the linkage for 1 value of TAU. */
+struct SweepResult {
+    double tau;
+    unsigned long clusters;       // clusters after linkage (outliers excluded)
+    unsigned long outliers;       // points that match with no model
+    unsigned long biggestCluster; // size of the biggest cluster
+    int linkages;
+    double milliseconds;          // preference + linkage time
+    std::vector<Cluster> clustering; // clusters followed by the outliers
+};
+
+/**
+ * Runs the T-Linkage for each given value of TAU, in parallel.
+ * Every run collapses the points by preference (see Cluster::clusterizeByPreference)
+ * then links the remaining clusters.
+ *
+ * @param dataSet the data set
+ * @param residuals the residuals of the data set (see ResidualMatrix::build)
+ * @param taus the tried values
+ * @return 1 result per value, in the same order
+ */
+std::vector<SweepResult> sweepTau(const PointPool &dataSet,
+                                  const ResidualMatrix &residuals,
+                                  const std::vector<double> &taus);
+
+/** Prints the sweep results as a table. */
+void printSweepSummary(const std::vector<SweepResult> &results, std::ostream &out = std::cout);
+
+#endif // SWEEP_H
@@ -0,0 +1,51 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Tiled T-Linkage for large images : the image is split in overlapping tiles
+ * that are processed independently (extraction, sampling, linkage), then the
+ * clusters found on both sides of each tile boundary are stitched together.
+ * The cost grows with the image area instead of the square of its edge points. */
+
+#ifndef TILING_H
+#define TILING_H
+
+#include "cluster.h"
+#include "image.h"
+
+/**
+ * Splits an image in tiles of tileSize x tileSize pixels (core regions), each
+ * one extended by overlap pixels on every side.
+ *
+ * @return the extended tiles, row by row
+ */
+std::vector<cv::Rect> splitInTiles(int cols, int rows, int tileSize = TILE_SIZE, int overlap = TILE_OVERLAP);
+
+/**
+ * Tiled T-Linkage with line models.
+ *
+ * 1. Every tile (extended with its overlap) is processed in parallel : point
+ *    extraction, adaptive sampling, preference collapsing and linkage.
+ * 2. Clusters of at least TILE_MIN_CLUSTER_SIZE points from neighbouring tiles are
+ *    stitched when their lines are compatible (angle and offset) and when enough of
+ *    their points in the shared overlap region agree with the other line.
+ * 3. Each point is only kept by the tile whose core region contains it, so that
+ *    points extracted twice in an overlap do not appear twice in the result.
+ *
+ * @param image contour image (output of contourCanny)
+ * @param gradX horizontal gradient of the image, may be empty
+ * @param gradY vertical gradient of the image, may be empty
+ * @param dataSet filled with the points of the result
+ * @param tileSize size of the core region of a tile, in pixels
+ * @param overlap overlap added on each side of a tile, in pixels
+ * @return the clusters (small clusters and outliers included)
+ */
+std::vector<Cluster> tiledLinkage(const cv::Mat &image,
+                                  const cv::Mat &gradX,
+                                  const cv::Mat &gradY,
+                                  PointPool &dataSet,
+                                  int tileSize = TILE_SIZE,
+                                  int overlap = TILE_OVERLAP);
+
+#endif // TILING_H
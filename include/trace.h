@@ -0,0 +1,91 @@
+/**
+ * Author        : Lysandre M. (lysandre.macke@enpc.fr)
+ * Created       : 10-19-2026
+ * Last modified : 10-19-2026
+ *
+ * Timeline tracing : scoped spans written as Chrome trace JSON (chrome://tracing,
+ * ui.perfetto.dev).
+ *
+ * Tracing is only compiled when TLK_TRACE is defined (cmake -DTLK_TRACE=ON),
+ * otherwise the TRACE_* macros expand to nothing. Events are recorded between
+ * Trace::start() and Trace::stop(). Each thread appends to its own preallocated
+ * buffer, so recording never takes a lock; buffers are only read by stop(). */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+/** Global trace of the run. */
+class Trace {
+public:
+    /** Starts recording events. */
+    static void start();
+
+    /**
+     * Stops recording and writes the recorded events to the given JSON file.
+     * Must not be called while other threads are recording.
+     *
+     * @return false if the file could not be written.
+     */
+    static bool stop(const std::string &path);
+
+    /** Returns weither events are being recorded or not. */
+    static bool recording();
+
+    /** Returns the current time of the trace clock, in nanoseconds. */
+    static long long now();
+
+    /**
+     * Records a complete span of the calling thread.
+     *
+     * @param name name of the span (must outlive the trace, ex. a string literal)
+     * @param start start time (see now())
+     * @param argName name of the optional argument (nullptr if none)
+     * @param argValue value of the optional argument
+     */
+    static void span(const char *name, long long start, const char *argName = nullptr, long argValue = 0);
+
+    /**
+     * Records a counter value (ex. number of clusters).
+     *
+     * @param name name of the counter (must outlive the trace)
+     */
+    static void counter(const char *name, long value);
+};
+
+/** Records a span of the calling thread during its lifetime. */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *argName = nullptr, long argValue = 0);
+
+    ~TraceSpan();
+
+    /** Sets the argument of the span, when its value is only known at the end. */
+    void setArg(const char *argName, long argValue);
+
+private:
+    const char *_name;
+    const char *_argName;
+    long _argValue;
+    long long _start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+
+#ifdef TLK_TRACE
+#define TRACE_SCOPE(name)                   TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg, value)   TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, arg, value)
+#define TRACE_COUNTER(name, value)          Trace::counter(name, value)
+#define TRACE_START()                       Trace::start()
+#define TRACE_STOP(path)                    Trace::stop(path)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, arg, value)
+#define TRACE_COUNTER(name, value)
+#define TRACE_START()
+#define TRACE_STOP(path)                    true
+#endif
+
+#endif // TRACE_H
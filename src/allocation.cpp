@@ -0,0 +1,75 @@
+#include "allocation.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<unsigned long> allocations {0};
+static std::atomic<size_t> bytes {0};
+
+#ifdef TLK_COUNT_ALLOCATIONS
+
+static void *countedAllocation(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *p = std::malloc(size ? size : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new(std::size_t size) {
+    return countedAllocation(size);
+}
+
+void *operator new[](std::size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif // TLK_COUNT_ALLOCATIONS
+
+bool allocationCountingEnabled() {
+#ifdef TLK_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+unsigned long allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+size_t allocatedBytes() {
+    return bytes.load(std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope() :
+    _startCount {allocationCount()},
+    _startBytes {allocatedBytes()} {}
+
+unsigned long AllocationScope::count() const {
+    return allocationCount() - _startCount;
+}
+
+size_t AllocationScope::bytes() const {
+    return allocatedBytes() - _startBytes;
+}
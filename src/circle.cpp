@@ -70,12 +70,112 @@ double Circle::PFValue(const Point &p) {
     return distance(*this, p) < 5*TAU ? exp(-distance(*this, p)/TAU) : 0;
 }
 
+Circle Circle::refine(const std::vector<std::shared_ptr<Point>> &points, int iterations) const {
+    const long n = points.size();
+    if(n < 3) {
+        return *this;
+    }
+
+    // contiguous coordinates so that the loops below vectorize
+    std::vector<double> xs(n), ys(n);
+    for(long i = 0; i < n; i++) {
+        xs[i] = points[i]->x();
+        ys[i] = points[i]->y();
+    }
+    const double *x = xs.data();
+    const double *y = ys.data();
+
+    double a = _p.x();
+    double b = _p.y();
+    double r = _r;
+
+    auto cost = [&](double a, double b, double r) {
+        double sum = 0.;
+        #pragma omp simd reduction(+:sum)
+        for(long i = 0; i < n; i++) {
+            auto e = std::sqrt((x[i] - a)*(x[i] - a) + (y[i] - b)*(y[i] - b)) - r;
+            sum += e*e;
+        }
+        return sum;
+    };
+    auto currentCost = cost(a, b, r);
+
+    for(int iter = 0; iter < iterations; iter++) {
+        // normal equations J^T J d = -J^T e, with e_i = d_i - r
+        // and J_i = (-(x_i - a)/d_i, -(y_i - b)/d_i, -1)
+        double juu = 0., juv = 0., jvv = 0., ju = 0., jv = 0.;
+        double eu = 0., ev = 0., e1 = 0.;
+
+        #pragma omp simd reduction(+:juu, juv, jvv, ju, jv, eu, ev, e1)
+        for(long i = 0; i < n; i++) {
+            auto dx = x[i] - a;
+            auto dy = y[i] - b;
+            auto d = std::sqrt(dx*dx + dy*dy);
+            auto u = d > 0. ? dx/d : 0.;
+            auto v = d > 0. ? dy/d : 0.;
+            auto e = d - r;
+            juu += u*u;
+            juv += u*v;
+            jvv += v*v;
+            ju  += u;
+            jv  += v;
+            eu  += e*u;
+            ev  += e*v;
+            e1  += e;
+        }
+
+        // solve the 3x3 system (Cramer's rule), unknowns (da, db, dr)
+        // [juu juv ju] [da]   [eu]
+        // [juv jvv jv] [db] = [ev]
+        // [ju  jv  n ] [dr]   [e1]
+        double m[3][3] = {{juu, juv, ju}, {juv, jvv, jv}, {ju, jv, static_cast<double>(n)}};
+        double rhs[3] = {eu, ev, e1};
+
+        auto det3 = [](double m[3][3]) {
+            return m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1])
+                 - m[0][1]*(m[1][0]*m[2][2] - m[1][2]*m[2][0])
+                 + m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+        };
+        auto det = det3(m);
+        if(std::abs(det) < 1e-15) {
+            break;
+        }
+
+        double delta[3];
+        for(int k = 0; k < 3; k++) {
+            double mk[3][3];
+            for(int i = 0; i < 3; i++) {
+                for(int j = 0; j < 3; j++) {
+                    mk[i][j] = j == k ? rhs[i] : m[i][j];
+                }
+            }
+            delta[k] = det3(mk)/det;
+        }
+
+        auto newA = a + delta[0];
+        auto newB = b + delta[1];
+        auto newR = r + delta[2];
+        auto newCost = cost(newA, newB, newR);
+
+        if(!(newCost < currentCost)) {
+            break;
+        }
+        a = newA;
+        b = newB;
+        r = newR;
+        currentCost = newCost;
+    }
+    return Circle(Point(a, b), std::abs(r));
+}
+
 std::vector<Circle> Circle::drawModels(unsigned int n, const PointPool &dataSet, int windowWidth, int windowHeight) {
-    assert(N_MODELS_TO_DRAW <= dataSet.size()/3);
+    assert(n <= dataSet.size()/3);
 
     std::vector<Circle> models;
+    unsigned int attempts = 0;
 
-    while(models.size() < N_MODELS_TO_DRAW) {
+    // same bound as Line::drawModels : a small data set may not give n distinct circles
+    while(models.size() < n && attempts++ < 10*n) {
         auto insert = true;
         std::vector<Point> circlePoints;
         circlePoints.emplace_back(*dataSet.at(std::rand() % dataSet.size()));
@@ -1,21 +1,28 @@
 #include "cluster.h"
+#include "consensus.h"
+#include "metrics.h"
+#include "trace.h"
 
 Cluster::Cluster() {}
 
 
-Cluster::Cluster(const Cluster& other) {
+Cluster::Cluster(const Cluster& other) :
+    _moments {other._moments},
+    _family {other._family} {
     for(auto point : other.points()) {
         _points.emplace_back(point);
     }
 }
 
-Cluster::Cluster(std::shared_ptr<Point>p) {
+Cluster::Cluster(std::shared_ptr<Point>p) :
+    _moments {*p} {
     _points.emplace_back(p);
 }
 
 Cluster::Cluster(const std::vector<std::shared_ptr<Point>> &points) {
     for(auto point : points) {
         _points.emplace_back(point);
+        _moments.add(*point);
     }
 }
 
@@ -87,6 +94,113 @@ std::vector<Cluster> Cluster::clusterize(const PointPool &points) {
 
 }
 
+/** Hash of a (quantized) preference function. */
+struct PreferenceHash {
+    size_t operator()(const std::vector<double> &pf) const {
+        size_t seed = pf.size();
+        for(auto value : pf) {
+            seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+};
+
+std::vector<Cluster> Cluster::clusterizeByPreference(const PointPool &points,
+                                                     const PreferenceMatrix &preferences,
+                                                     std::vector<Cluster> &outliers) {
+    TRACE_SCOPE("clusterizeByPreference");
+    assert(preferences.rows() == points.size());
+
+    std::vector<Cluster> clusters;
+    std::unordered_map<std::vector<double>, int, PreferenceHash> clusterOf;
+    std::vector<double> key(preferences.cols());
+
+    for(unsigned long i = 0; i < points.size(); i++) {
+        auto pf = preferences.row(i);
+        auto empty = true;
+
+        for(unsigned long m = 0; m < preferences.cols(); m++) {
+            auto value = PreferencePrecision::load(pf[m]);
+            key[m] = PREFERENCE_QUANTIZATION > 0
+                    ? std::round(value * PREFERENCE_QUANTIZATION) / PREFERENCE_QUANTIZATION
+                    : value;
+            empty = empty && value <= 0.;
+        }
+
+        if(empty) {
+            outliers.emplace_back(Cluster(points[i]));
+            continue;
+        }
+        auto it = clusterOf.find(key);
+        if(it == clusterOf.end()) {
+            clusterOf.emplace(key, clusters.size());
+            clusters.emplace_back(Cluster(points[i]));
+        }
+        else {
+            clusters[it->second].addPoint(points[i]);
+        }
+    }
+
+    std::cout << "[DEBUG] Preference collapsing : " << points.size() << " points -> " << clusters.size()
+              << " clusters + " << outliers.size() << " outliers." << std::endl;
+    return clusters;
+}
+
+std::vector<Cluster> Cluster::clusterizeByPreference(const PointPool &points,
+                                                     const std::vector<Line> &models,
+                                                     std::vector<Cluster> &outliers) {
+    return clusterizeByPreference(points, PreferenceMatrix::build(points, models), outliers);
+}
+
+std::vector<Cluster> Cluster::clusterizeByPreference(const PointPool &points,
+                                                     const std::vector<Circle> &models,
+                                                     std::vector<Cluster> &outliers) {
+    return clusterizeByPreference(points, PreferenceMatrix::build(points, models), outliers);
+}
+
+/** Hash of a consensus set. */
+struct ConsensusHash {
+    size_t operator()(const std::vector<uint64_t> &bits) const {
+        size_t seed = bits.size();
+        for(auto word : bits) {
+            seed ^= std::hash<uint64_t>()(word) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+};
+
+std::vector<Cluster> Cluster::clusterizeByConsensus(const PointPool &points,
+                                                    const ConsensusMatrix &consensus,
+                                                    std::vector<Cluster> &outliers) {
+    TRACE_SCOPE("clusterizeByConsensus");
+    assert(consensus.rows() == points.size());
+
+    std::vector<Cluster> clusters;
+    std::unordered_map<std::vector<uint64_t>, int, ConsensusHash> clusterOf;
+    std::vector<uint64_t> key(consensus.words());
+
+    for(unsigned long i = 0; i < points.size(); i++) {
+        if(consensus.count(i) == 0) {
+            outliers.emplace_back(Cluster(points[i]));
+            continue;
+        }
+        key.assign(consensus.row(i), consensus.row(i) + consensus.words());
+
+        auto it = clusterOf.find(key);
+        if(it == clusterOf.end()) {
+            clusterOf.emplace(key, clusters.size());
+            clusters.emplace_back(Cluster(points[i]));
+        }
+        else {
+            clusters[it->second].addPoint(points[i]);
+        }
+    }
+
+    std::cout << "[DEBUG] Consensus collapsing : " << points.size() << " points -> " << clusters.size()
+              << " clusters + " << outliers.size() << " outliers." << std::endl;
+    return clusters;
+}
+
 std::ostream &operator<<(std::ostream &out, Cluster &cluster) {
     for(auto point : cluster.points()) {
         std::cout << point << std::endl;
@@ -94,17 +208,47 @@ std::ostream &operator<<(std::ostream &out, Cluster &cluster) {
     return out;
 }
 
-std::vector<std::shared_ptr<Point>> Cluster::points() const {
+const std::vector<std::shared_ptr<Point>> &Cluster::points() const {
     return _points;
 }
 
 
 void Cluster::addPoint(std::shared_ptr<Point>p) {
     _points.emplace_back(p);
+    _moments.add(*p);
 }
 
-void Cluster::addPoints(std::vector<std::shared_ptr<Point>> points) {
+void Cluster::addPoints(const std::vector<std::shared_ptr<Point>> &points) {
     _points.insert(_points.end(), points.begin(), points.end());
+    for(const auto &point : points) {
+        _moments.add(*point);
+    }
+}
+
+void Cluster::merge(const Cluster &other) {
+    _points.insert(_points.end(), other._points.begin(), other._points.end());
+    _moments.merge(other._moments);
+}
+
+const Moments &Cluster::moments() const {
+    return _moments;
+}
+
+Line Cluster::lineModel() const {
+    return _moments.fitLine();
+}
+
+Circle Cluster::circleModel(bool refine) const {
+    auto circle = _moments.fitCircle();
+    return refine ? circle.refine(_points) : circle;
+}
+
+ModelFamily Cluster::family() const {
+    return _family;
+}
+
+void Cluster::setFamily(ModelFamily family) {
+    _family = family;
 }
 
 void Cluster::validate() {
@@ -119,13 +263,13 @@ void Cluster::invalidate() {
     }
 }
 
-int Cluster::size() {
+int Cluster::size() const {
     return _points.size();
 }
 
 void Cluster::displayClusters(const std::vector<Cluster> &clusters, int windowWidth, int windowHeight) {
-    for(auto cluster:clusters) {
-        for(auto point : cluster.points()) {
+    for(const auto &cluster : clusters) {
+        for(const auto &point : cluster.points()) {
             point->display(windowWidth, windowHeight);
         }
     }
@@ -135,9 +279,9 @@ void Cluster::displayClustersWithColors(const std::vector<Cluster> &clusters, in
     Imagine::Color cols[] = COLOR_PACK;
     int i = 0;
 
-    for(auto cluster:clusters) {
+    for(const auto &cluster : clusters) {
         auto col = cols[i % N_COLORS];
-        for(auto point : cluster.points()) {
+        for(const auto &point : cluster.points()) {
             point->display(col, windowWidth, windowHeight);
         }
         i++;
@@ -145,11 +289,11 @@ void Cluster::displayClustersWithColors(const std::vector<Cluster> &clusters, in
 }
 
 void Cluster::displayValidated(const std::vector<Cluster> &clusters, int windowWidth, int windowHeight) {
-    for(auto cluster : clusters) {
+    for(const auto &cluster : clusters) {
         if(cluster.isModel()) {
             std::cout << "[DEBUG] VALID MODEL of size " << cluster.size() << std::endl;
 
-            for(auto point : cluster.points()) {
+            for(const auto &point : cluster.points()) {
                     point->display(windowWidth, windowHeight);
             }
         }
@@ -160,7 +304,7 @@ void Cluster::displayValidatedOnImage(const std::vector<Cluster> &clusters, int
     for(auto cluster : clusters) {
         if(cluster.isModel()) {
             std::cout << "[DEBUG] VALID MODEL of size " << cluster.size() << std::endl;
-            auto line = Line::leastSquares(cluster._points);
+            auto line = cluster.lineModel();
             drawLineOnImage(image, line);
         }
     }
@@ -168,9 +312,14 @@ void Cluster::displayValidatedOnImage(const std::vector<Cluster> &clusters, int
 
 void Cluster::displayModels(const std::vector<Cluster> &clusters, int windowWidth, int windowHeight) {
     for(auto cluster : clusters) {
-        if(cluster.isModel()) {
-            auto model = Line::leastSquares(cluster._points);
-            model.display(windowWidth, windowHeight);
+        if(!cluster.isModel()) {
+            continue;
+        }
+        if(cluster.family() == ModelFamily::CIRCLE && cluster.size() >= 3) {
+            cluster.circleModel().display(windowWidth, windowHeight);
+        }
+        else {
+            cluster.lineModel().display(windowWidth, windowHeight);
         }
     }
 }
@@ -202,10 +351,12 @@ std::vector<double> Cluster::computePF(const std::vector<Line> &models, PointPoo
 //    }
 
     // find min PF value for each model
+    pf.reserve(models.size());
+
     for(auto model : models) {
         auto min = model.PFValue(*_points.at(0)); // temporary min value
         // compare for each point to find min
-        for(auto point : _points) {
+        for(const auto &point : _points) {
             auto tmp = model.PFValue(*point);
             if(tmp < min) {
                 min = tmp;
@@ -229,10 +380,12 @@ std::vector<double> Cluster::computePF(const std::vector<Circle> &models, PointP
 //    }
 
     // find min PF value for each model
+    pf.reserve(models.size());
+
     for(auto model : models) {
         auto min = model.PFValue(*_points.at(0)); // temporary min value
         // compare for each point to find min
-        for(auto point : _points) {
+        for(const auto &point : _points) {
             auto tmp = model.PFValue(*point);
             if(tmp < min) {
                 min = tmp;
@@ -246,8 +399,8 @@ std::vector<double> Cluster::computePF(const std::vector<Circle> &models, PointP
     return pf;
 }
 
-bool Cluster::isModel() {
-    for(auto point : _points) {
+bool Cluster::isModel() const {
+    for(const auto &point : _points) {
         if(!point->isInlier()) {
             return false;
         }
@@ -261,13 +414,41 @@ bool Cluster::isModel() {
 ////////////////////////////////////////////////////////////////////////////////////
 
 
-double tanimoto(std::vector<double> a, std::vector<double> b) {
+double jaccard(std::set<Line> a, std::set<Line> b) {
+    std::vector<Line> intersection;
+    std::vector<Line> reunion;
+
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(intersection));
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(reunion));
+
+    if(reunion.empty()) {
+        return 1.;
+    }
+    return 1. - static_cast<double>(intersection.size())/reunion.size();
+}
+
+double tanimoto(const std::vector<double> &a, const std::vector<double> &b) {
     assert(a.size() == b.size());
 
-    double a_squaredNorm = std::inner_product(a.begin(), a.end(), a.begin(), 0.0L);
-    double b_squaredNorm = std::inner_product(b.begin(), b.end(), b.begin(), 0.0L);
+    // same kernel as the preference matrix : 1 pass, double sums
+    return tanimoto(a.data(), b.data(), a.size());
+}
+
+double tanimoto(const double *a, const double *b, unsigned long size) {
+    double a_squaredNorm = 0.;
+    double b_squaredNorm = 0.;
+    double ab_innerProduct = 0.;
 
-    double ab_innerProduct = std::inner_product(a.begin(), a.end(), b.begin(), 0.0L);
+    for(unsigned long i = 0; i < size; i++) {
+        a_squaredNorm   += a[i]*a[i];
+        b_squaredNorm   += b[i]*b[i];
+        ab_innerProduct += a[i]*b[i];
+    }
+
+    // 2 empty preference functions have nothing in common
+    if(a_squaredNorm + b_squaredNorm - ab_innerProduct <= 0.) {
+        return 1.;
+    }
 
     return 1 - ab_innerProduct/(a_squaredNorm + b_squaredNorm - ab_innerProduct);
 }
@@ -281,13 +462,22 @@ bool link(std::vector<Cluster> &clusters, PointPool &dataSet, const std::vector<
     int j          = 0;     // second loop index
 
 
+    TRACE_SCOPE_ARG("link round", "clusters", clusters.size());
+
+    // preference functions are computed once per cluster
+    std::vector<std::vector<double>> pfs;
+    pfs.reserve(clusters.size());
+    for(auto &cluster : clusters) {
+        pfs.emplace_back(cluster.computePF(models, dataSet));
+    }
+    METRICS_COUNT(Counter::PF_EVALUATIONS, dataSet.size()*models.size());
+    METRICS_COUNT(Counter::DISTANCE_EVALUATIONS, clusters.size()*(clusters.size() - 1));
+
     // find closest clusters according to jaccard distance
-    for(auto c1 : clusters) {
+    for(const auto &pf1 : pfs) {
         j = 0;
-        auto pf1 = c1.computePF(models, dataSet);
         // for each other buffer
-        for(auto c2 : clusters) {
-            auto pf2 = c2.computePF(models, dataSet);
+        for(const auto &pf2 : pfs) {
             // compare indexes so we don't try to merge a cluster with itself
             double dist = i != j ? tanimoto(pf1, pf2) : 1.;
 
@@ -330,13 +520,22 @@ bool link(std::vector<Cluster> &clusters, PointPool &dataSet, const std::vector<
     int j          = 0;     // second loop index
 
 
+    TRACE_SCOPE_ARG("link round", "clusters", clusters.size());
+
+    // preference functions are computed once per cluster
+    std::vector<std::vector<double>> pfs;
+    pfs.reserve(clusters.size());
+    for(auto &cluster : clusters) {
+        pfs.emplace_back(cluster.computePF(models, dataSet));
+    }
+    METRICS_COUNT(Counter::PF_EVALUATIONS, dataSet.size()*models.size());
+    METRICS_COUNT(Counter::DISTANCE_EVALUATIONS, clusters.size()*(clusters.size() - 1));
+
     // find closest clusters according to jaccard distance
-    for(auto c1 : clusters) {
+    for(const auto &pf1 : pfs) {
         j = 0;
-        auto pf1 = c1.computePF(models, dataSet);
         // for each other buffer
-        for(auto c2 : clusters) {
-            auto pf2 = c2.computePF(models, dataSet);
+        for(const auto &pf2 : pfs) {
             // compare indexes so we don't try to merge a cluster with itself
             double dist = i != j ? tanimoto(pf1, pf2) : 1.;
 
@@ -0,0 +1,191 @@
+#include "consensus.h"
+#include "cluster.h"
+#include "metrics.h"
+#include "trace.h"
+
+ConsensusMatrix::ConsensusMatrix() :
+    _rows {0},
+    _cols {0},
+    _words {0} {}
+
+ConsensusMatrix::ConsensusMatrix(const PreferenceMatrix &preferences) :
+    _rows {preferences.rows()},
+    _cols {preferences.cols()},
+    _words {(preferences.cols() + 63)/64},
+    _bits(_rows*_words, 0) {
+
+    #pragma omp parallel for
+    for(long i = 0; i < static_cast<long>(_rows); i++) {
+        auto pf = preferences.row(i);
+        auto bits = _bits.data() + i*_words;
+        for(unsigned long j = 0; j < _cols; j++) {
+            if(pf[j] > 0.) {
+                bits[j/64] |= uint64_t(1) << (j % 64);
+            }
+        }
+    }
+}
+
+ConsensusMatrix::ConsensusMatrix(unsigned long rows, unsigned long cols) :
+    _rows {rows},
+    _cols {cols},
+    _words {(cols + 63)/64},
+    _bits(_rows*_words, 0) {}
+
+/**
+ * Sets the j-th bit of the i-th row if all points of the i-th cluster are inliers of
+ * the j-th model (inlier(j, point)).
+ */
+template<typename Inlier>
+static ConsensusMatrix buildFor(const std::vector<Cluster> &clusters, unsigned long cols, Inlier inlier) {
+    TRACE_SCOPE_ARG("consensus matrix", "rows", clusters.size());
+    ConsensusMatrix cm(clusters.size(), cols);
+    unsigned long evaluations = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+    for(long i = 0; i < static_cast<long>(clusters.size()); i++) {
+        const auto &points = clusters[i].points();
+        assert(points.size() > 0);
+        auto bits = cm.row(i);
+
+        for(unsigned long j = 0; j < cols; j++) {
+            auto isInlier = true;
+            size_t k = 0;
+            for(; k < points.size() && isInlier; k++) {
+                isInlier = inlier(j, *points[k]);
+            }
+            evaluations += k;
+            if(isInlier) {
+                bits[j/64] |= uint64_t(1) << (j % 64);
+            }
+        }
+    }
+    METRICS_COUNT(Counter::PF_EVALUATIONS, evaluations);
+    return cm;
+}
+
+template<typename Model>
+static ConsensusMatrix buildFor(const std::vector<Cluster> &clusters, std::vector<Model> models) {
+    return buildFor(clusters, models.size(), [&](unsigned long j, const Point &point) {
+        return models[j].PFValue(point) > 0.;
+    });
+}
+
+static ConsensusMatrix buildMixed(const std::vector<Cluster> &clusters,
+                                  std::vector<Line> lines,
+                                  std::vector<Circle> circles) {
+    const auto nLines = lines.size();
+    return buildFor(clusters, nLines + circles.size(), [&](unsigned long j, const Point &point) {
+        return j < nLines ? lines[j].PFValue(point) > 0. : circles[j - nLines].PFValue(point) > 0.;
+    });
+}
+
+ConsensusMatrix ConsensusMatrix::build(const PointPool &dataSet, const std::vector<Line> &models) {
+    return buildFor(Cluster::clusterize(dataSet), models);
+}
+
+ConsensusMatrix ConsensusMatrix::build(const PointPool &dataSet, const std::vector<Circle> &models) {
+    return buildFor(Cluster::clusterize(dataSet), models);
+}
+
+ConsensusMatrix ConsensusMatrix::build(const std::vector<Cluster> &clusters, const std::vector<Line> &models) {
+    return buildFor(clusters, models);
+}
+
+ConsensusMatrix ConsensusMatrix::build(const std::vector<Cluster> &clusters, const std::vector<Circle> &models) {
+    return buildFor(clusters, models);
+}
+
+ConsensusMatrix ConsensusMatrix::build(const PointPool &dataSet,
+                                       const std::vector<Line> &lines,
+                                       const std::vector<Circle> &circles) {
+    return buildMixed(Cluster::clusterize(dataSet), lines, circles);
+}
+
+ConsensusMatrix ConsensusMatrix::build(const std::vector<Cluster> &clusters,
+                                       const std::vector<Line> &lines,
+                                       const std::vector<Circle> &circles) {
+    return buildMixed(clusters, lines, circles);
+}
+
+unsigned long ConsensusMatrix::rows() const {
+    return _rows;
+}
+
+unsigned long ConsensusMatrix::cols() const {
+    return _cols;
+}
+
+uint64_t *ConsensusMatrix::row(unsigned long i) {
+    return _bits.data() + i*_words;
+}
+
+const uint64_t *ConsensusMatrix::row(unsigned long i) const {
+    return _bits.data() + i*_words;
+}
+
+unsigned long ConsensusMatrix::words() const {
+    return _words;
+}
+
+bool ConsensusMatrix::test(unsigned long i, unsigned long j) const {
+    return (_bits[i*_words + j/64] >> (j % 64)) & 1;
+}
+
+unsigned long ConsensusMatrix::count(unsigned long i) const {
+    auto bits = _bits.data() + i*_words;
+    unsigned long count = 0;
+    for(unsigned long w = 0; w < _words; w++) {
+        count += __builtin_popcountll(bits[w]);
+    }
+    return count;
+}
+
+double ConsensusMatrix::distance(unsigned long i, unsigned long j) const {
+    auto a = _bits.data() + i*_words;
+    auto b = _bits.data() + j*_words;
+    unsigned long intersection = 0;
+    unsigned long reunion = 0;
+
+    for(unsigned long w = 0; w < _words; w++) {
+        intersection += __builtin_popcountll(a[w] & b[w]);
+        reunion      += __builtin_popcountll(a[w] | b[w]);
+    }
+
+    // 2 empty consensus sets have nothing in common
+    if(reunion == 0) {
+        return 1.;
+    }
+    return 1. - static_cast<double>(intersection)/reunion;
+}
+
+void ConsensusMatrix::merge(unsigned long i, unsigned long j) {
+    auto a = _bits.data() + i*_words;
+    auto b = _bits.data() + j*_words;
+    for(unsigned long w = 0; w < _words; w++) {
+        a[w] &= b[w];
+    }
+}
+
+ModelFamily ConsensusMatrix::bestFamily(unsigned long i, unsigned long nLines) const {
+    auto inFamily = [&](unsigned long first, unsigned long last) {
+        for(unsigned long j = first; j < last; j++) {
+            if(test(i, j)) {
+                return 1.;
+            }
+        }
+        return 0.;
+    };
+    auto bestLine = inFamily(0, nLines);
+    auto bestCircle = inFamily(nLines, _cols);
+
+    if(bestLine <= 0. && bestCircle <= 0.) {
+        return ModelFamily::NONE;
+    }
+    // a line is the simplest model : it wins against (almost) flat circles
+    return bestLine >= MIXED_LINE_TOLERANCE*bestCircle ? ModelFamily::LINE : ModelFamily::CIRCLE;
+}
+
+size_t ConsensusMatrix::bytes() const {
+    return _bits.size()*sizeof(uint64_t);
+}
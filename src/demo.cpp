@@ -24,7 +24,22 @@
 #include "line.h"
 #include "circle.h"
 #include "cluster.h"
+#include "linkage.h"
+#include "allocation.h"
+#include "metrics.h"
+#include "trace.h"
 #include "image.h"
+#include "scalespace.h"
+#include "sampling.h"
+#include "compaction.h"
+#include "multiresolution.h"
+#include "refinement.h"
+#include "sweep.h"
+#include "tiling.h"
+#include "sharding.h"
+#include "lsh.h"
+#include "renderer.h"
+#include "anytime.h"
 using namespace std;
 
 
@@ -40,7 +55,13 @@ int main(int argc, char **argv) {
     int windowWidth, windowHeight;
     PointPool dataSet;
     cv::Mat inputImage;
+    std::vector<Cluster> tiledClusters;
 
+    // one span per processed image
+    TRACE_START();
+#ifdef TLK_TRACE
+    auto imageStart = Trace::now();
+#endif
 
     // load image
     if(1) {
@@ -50,19 +71,32 @@ int main(int argc, char **argv) {
         std::string imageSrc = "../T-Linkage/input/"; // change to /input for final commit
         imageSrc += DEFAULT_IMAGE;
 
+        METRICS_START(Stage::LOAD);
         if(!loadImage(imageSrc, inputImage)) {
             return -1;
         }
+        METRICS_STOP(Stage::LOAD);
 
         cv::imshow("Input image", inputImage);
+        METRICS_START(Stage::EDGE_DETECTION);
         cv::Mat image = inputImage.clone();
         contourCanny(image);
+        METRICS_STOP(Stage::EDGE_DETECTION);
         cv::imshow("contour", image);
 
         windowWidth = image.cols;
         windowHeight = image.rows;
 
-        dataSet = extractPointsFromImage(image);
+        METRICS_START(Stage::EXTRACTION);
+        cv::Mat gradX, gradY;
+        computeGradients(inputImage, gradX, gradY);
+#if TILED_MODE
+        tiledClusters = tiledLinkage(image, gradX, gradY, dataSet);
+#else
+        dataSet = extractPointsFromImage(image, gradX, gradY);
+//        dataSet = ScaleSpace(inputImage, SCALE_SPACE_LEVELS).extractPointsAcrossScales(); // multi-scale contours
+#endif
+        METRICS_STOP(Stage::EXTRACTION);
 
         if(dataSet.size() == 0) {
             fprintf(stderr,
@@ -95,8 +129,20 @@ int main(int argc, char **argv) {
         }
     }
 
+#if SPATIAL_ORDER
+    // original indexes : dataSet.originalIndex(i)
+    dataSet.sortAlongCurve(SpaceFillingCurve::HILBERT);
+#endif
     Imagine::openWindow(windowWidth, windowHeight);
 
+#if TILED_MODE
+    // image mode only : the tiles replace the sampling and the global linkage below
+    validateNBiggestClusters(1, tiledClusters);
+    Cluster::displayValidated(tiledClusters, windowWidth, windowHeight);
+    std::cout << "[DEBUG] Ending with " << tiledClusters.size() << " clusters." << std::endl;
+    Imagine::endGraphics();
+    return 0;
+#endif
 
     // cluster generation
     auto clusters = Cluster::clusterize(dataSet);
@@ -105,8 +151,23 @@ int main(int argc, char **argv) {
     Cluster::displayClusters(clusters, windowWidth, windowHeight);
 
     // extract models from clusterized set
+    METRICS_START(Stage::SAMPLING);
 //    auto models = Line::drawModels(N_MODELS_TO_DRAW, dataSet);
-    auto models = Circle::drawModels(N_MODELS_TO_DRAW, dataSet, windowWidth, windowHeight);
+//    auto models = Line::drawModelsFromGradients(N_MODELS_TO_DRAW, dataSet); // image mode only
+//    auto models = Circle::drawModels(N_MODELS_TO_DRAW, dataSet, windowWidth, windowHeight);
+    auto models = drawModelsAdaptive<Circle>(dataSet, [&](unsigned int n) {
+        return Circle::drawModels(n, dataSet, windowWidth, windowHeight);
+    });
+    models = compactModels(dataSet, models);
+    METRICS_STOP(Stage::SAMPLING);
+
+#if TAU_SWEEP
+    // residuals are shared by all the runs, only the linkage is repeated
+    auto sweep = sweepTau(dataSet, ResidualMatrix::build(dataSet, models), TAU_SWEEP_VALUES);
+    printSweepSummary(sweep);
+    Imagine::endGraphics();
+    return 0;
+#endif
 
     ////////////////////////-->
     /// for debug (remove after)
@@ -122,21 +183,155 @@ int main(int argc, char **argv) {
 
     //<--/////////////////////////////////////
 
+    // identical preference functions start together, empty ones are outliers
+    METRICS_START(Stage::PREFERENCE);
+    std::vector<Cluster> outliers;
+#if MIXED_MODELS
+    // line models share the preference space of the circle models
+    auto lineModels = drawModelsAdaptive<Line>(dataSet, [&](unsigned int n) {
+        return Line::drawModels(n, dataSet);
+    });
+    lineModels = compactModels(dataSet, lineModels);
+#endif
+#if J_LINKAGE && MIXED_MODELS
+    // consensus sets straight from the residuals : no dense preference matrix
+    clusters = Cluster::clusterizeByConsensus(dataSet, ConsensusMatrix::build(dataSet, lineModels, models), outliers);
+    auto preferences = ConsensusMatrix::build(clusters, lineModels, models);
+#elif J_LINKAGE
+    clusters = Cluster::clusterizeByConsensus(dataSet, ConsensusMatrix::build(dataSet, models), outliers);
+    auto preferences = ConsensusMatrix::build(clusters, models);
+#elif MIXED_MODELS
+    clusters = Cluster::clusterizeByPreference(dataSet, PreferenceMatrix::build(dataSet, lineModels, models), outliers);
+    auto preferences = PreferenceMatrix::build(clusters, lineModels, models);
+#else
+    clusters = Cluster::clusterizeByPreference(dataSet, models, outliers);
+    auto preferences = PreferenceMatrix::build(clusters, models);
+#endif
+    METRICS_STOP(Stage::PREFERENCE);
+
+#if LSH_LINKAGE && !J_LINKAGE && !MULTIRESOLUTION_LINKAGE
+    // quality of the approximation, measured outside of the timed linkage
+    std::cout << "[DEBUG] LSH recall : " << lshRecall(preferences) << std::endl;
+#if LSH_AGREEMENT
+    TLinkage exactLinkage(clusters, preferences);
+    exactLinkage.run();
+    auto exactClusters = exactLinkage.clusters();
+#endif
+#endif
+
+#if MULTIRESOLUTION_LINKAGE
+    // the multiresolution linkage fits line models only
+    METRICS_START(Stage::SAMPLING);
+    auto multiresolutionModels = drawModelsAdaptive<Line>(dataSet, [&](unsigned int n) {
+        return Line::drawModels(n, dataSet);
+    });
+    METRICS_STOP(Stage::SAMPLING);
+#endif
+
     // START ALGORITHM
     auto start = chrono::steady_clock::now();
 
     std::cout << "[DEBUG] Linking clusters, please wait... " << std::endl;
+    METRICS_START(Stage::LINKAGE);
+
+#if MULTIRESOLUTION_LINKAGE
+    // coarse-to-fine T-Linkage over the whole data set, outliers included
+    AnytimeResult result;
+    result.clusters = multiresolutionLinkage(dataSet, multiresolutionModels);
+    result.merges = dataSet.size() - result.clusters.size();
+    METRICS_STOP(Stage::LINKAGE);
+    clusters = result.clusters;
+#elif SHARDED_LINKAGE && !J_LINKAGE && !LSH_LINKAGE
+    // multi-process T-Linkage, runs to completion
+    AnytimeResult result;
+    result.clusters = shardedLinkage(clusters, preferences, LINKAGE_WORKERS);
+    result.merges = clusters.size() - result.clusters.size();
+    result.clusters.insert(result.clusters.end(), outliers.begin(), outliers.end());
+    METRICS_STOP(Stage::LINKAGE);
+    clusters = result.clusters;
+#else
+    // the setup of the engine counts in the deadline, and can be interrupted
+    auto budget = LinkageBudget::seconds(LINKAGE_DEADLINE);
+    if(LINKAGE_MAX_MERGES > 0) {
+        budget.maxMerges = LINKAGE_MAX_MERGES;
+    }
 
     // link until model is found
-    auto linkable = true;
-    int linkIndex = 0;
-    while(linkable) {
-        linkIndex++;
-        linkable = link(clusters, dataSet, models);
-        std::cout << "linked 2 clusters. Number of clusters : " << clusters.size() << std::endl;
+#if J_LINKAGE
+    JLinkage linkage(clusters, preferences, LINKAGE_MEMORY_BUDGET, budget);
+#elif LSH_LINKAGE
+    LshLinkage linkage(clusters, preferences, LSH_BANDS, LSH_ROWS, budget);
+#else
+    TLinkage linkage(clusters, preferences, LINKAGE_MEMORY_BUDGET, budget);
+#endif
+
+#if !LSH_LINKAGE
+    // throttled snapshots, drawn on another thread
+    ProgressLogger progressLogger;
+    linkage.addObserver(&progressLogger);
+#if PROGRESS_MODE
+    AsyncRenderer renderer(clusters, windowWidth, windowHeight,
+                           PROGRESS_MODE == 2 ? RenderMode::PNG : RenderMode::WINDOW);
+    linkage.addObserver(&renderer);
+#endif
+#endif
+
+    AllocationScope allocationScope;
+
+    // current clusters and outliers, validated below
+#if MIXED_MODELS
+    auto result = anytimeLinkage(linkage, budget, outliers, 0, lineModels.size());
+#else
+    auto result = anytimeLinkage(linkage, budget, outliers, 0);
+#endif
+    METRICS_STOP(Stage::LINKAGE);
+    if(allocationCountingEnabled()) {
+        std::cout << "[DEBUG] Heap allocations during linkage : " << allocationScope.count()
+                  << " (" << allocationScope.bytes() << " bytes)" << std::endl;
+    }
+#if !LSH_LINKAGE && PROGRESS_MODE
+    renderer.finish();
+    std::cout << "[DEBUG] Linkage frames drawn : " << renderer.frames() << std::endl;
+#endif
+    clusters = result.clusters;
+    std::cout << "[DEBUG] Linkage peak memory : " << linkage.peakMemory()/1024 << " kB" << std::endl;
+#if LSH_LINKAGE && !J_LINKAGE && LSH_AGREEMENT
+    std::cout << "[DEBUG] LSH agreement with T-Linkage (Rand index) : "
+              << clusteringAgreement(linkage.clusters(), exactClusters) << std::endl;
+#endif
+
+#if MIXED_MODELS
+    int nLineClusters = 0;
+    int nCircleClusters = 0;
+    for(const auto &cluster : clusters) {
+        nLineClusters += cluster.family() == ModelFamily::LINE;
+        nCircleClusters += cluster.family() == ModelFamily::CIRCLE;
     }
+    std::cout << "[DEBUG] Mixed models : " << nLineClusters << " line clusters, "
+              << nCircleClusters << " circle clusters." << std::endl;
+#endif
+#endif
     auto end = chrono::steady_clock::now();
-    validateNBiggestClusters(1, clusters);
+    METRICS_START(Stage::VALIDATION);
+    if(!clusters.empty()) {
+        validateNBiggestClusters(1, clusters);
+    }
+    METRICS_STOP(Stage::VALIDATION);
+
+    // models of the linkage : lines, circles, or the family of each cluster
+    METRICS_START(Stage::REFINEMENT);
+#if MULTIRESOLUTION_LINKAGE
+    clusters = refineLineModels(clusters);
+#elif MIXED_MODELS
+    clusters = refineMixedModels(clusters);
+#else
+    clusters = refineCircleModels(clusters);
+#endif
+    METRICS_STOP(Stage::REFINEMENT);
+#ifdef TLK_TRACE
+    Trace::span("image", imageStart, "points", dataSet.size());
+#endif
+//    clusters = refineLineModels(clusters);
 //    validateBiggestClusters(clusters, dataSet.size());
 //    validateBiggestClusters_2(clusters, dataSet.size());
 
@@ -148,6 +343,10 @@ int main(int argc, char **argv) {
     Imagine::setActiveWindow(resWindow);
 //    Cluster::displayClustersWithColors(clusters, windowWidth, windowHeight);
     Cluster::displayValidated(clusters, windowWidth, windowHeight);
+#if MIXED_MODELS
+    // line or circle, following the family of each cluster
+    Cluster::displayModels(clusters, windowWidth, windowHeight);
+#endif
 
 //    Cluster::displayModels(clusters, windowWidth, windowHeight);
 
@@ -157,8 +356,17 @@ int main(int argc, char **argv) {
 //    }
 
 
-    std::cout << "[DEBUG] Ending with " << clusters.size() << " clusters after " << linkIndex << " linkages." << std::endl;
+    std::cout << "[DEBUG] Ending with " << clusters.size() << " clusters after " << result.merges << " linkages"
+              << (result.partial ? " (partial clustering)." : ".") << std::endl;
     cout << "Time took : " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+#ifdef TLK_METRICS
+    if(!Metrics::writeJson(METRICS_FILE)) {
+        fprintf(stderr, "Error : could not write %s.\n", METRICS_FILE);
+    }
+#endif
+    if(!TRACE_STOP(TRACE_FILE)) {
+        fprintf(stderr, "Error : could not write %s.\n", TRACE_FILE);
+    }
     Imagine::endGraphics();
 
     return 0;
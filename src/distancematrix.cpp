@@ -0,0 +1,66 @@
+#include "distancematrix.h"
+
+#include <cassert>
+#include <algorithm>
+
+DistanceMatrix::DistanceMatrix() :
+    _n {0},
+    _nBlocks {0},
+    _cachedBlockRows {0} {}
+
+DistanceMatrix::DistanceMatrix(unsigned long n, size_t memoryBudget) :
+    _n {n},
+    _nBlocks {(n + DISTANCE_BLOCK_SIZE - 1)/DISTANCE_BLOCK_SIZE},
+    _cachedBlockRows {0} {
+    const size_t tileSize = DISTANCE_BLOCK_SIZE*DISTANCE_BLOCK_SIZE;
+    size_t total = 0;
+
+    // keep as many rows of tiles as the budget allows
+    while(_cachedBlockRows < _nBlocks) {
+        size_t rowSize = (_nBlocks - _cachedBlockRows)*tileSize;
+        if((total + rowSize)*sizeof(float) > memoryBudget) {
+            break;
+        }
+        _rowOffsets.emplace_back(total);
+        total += rowSize;
+        _cachedBlockRows++;
+    }
+    _values.assign(total, 1.f);
+}
+
+unsigned long DistanceMatrix::size() const {
+    return _n;
+}
+
+unsigned long DistanceMatrix::cachedRows() const {
+    return std::min(_n, _cachedBlockRows*DISTANCE_BLOCK_SIZE);
+}
+
+bool DistanceMatrix::isCached(unsigned long i, unsigned long j) const {
+    return std::min(i, j)/DISTANCE_BLOCK_SIZE < _cachedBlockRows;
+}
+
+float DistanceMatrix::get(unsigned long i, unsigned long j) const {
+    assert(isCached(i, j));
+    return i < j ? _values[index(i, j)] : _values[index(j, i)];
+}
+
+void DistanceMatrix::set(unsigned long i, unsigned long j, float value) {
+    if(!isCached(i, j)) {
+        return;
+    }
+    _values[i < j ? index(i, j) : index(j, i)] = value;
+}
+
+size_t DistanceMatrix::bytes() const {
+    return _values.size()*sizeof(float);
+}
+
+size_t DistanceMatrix::index(unsigned long i, unsigned long j) const {
+    auto bi = i/DISTANCE_BLOCK_SIZE;
+    auto bj = j/DISTANCE_BLOCK_SIZE;
+    return _rowOffsets[bi]
+            + (bj - bi)*DISTANCE_BLOCK_SIZE*DISTANCE_BLOCK_SIZE
+            + (i % DISTANCE_BLOCK_SIZE)*DISTANCE_BLOCK_SIZE
+            + j % DISTANCE_BLOCK_SIZE;
+}
@@ -0,0 +1,120 @@
+#include "gram.h"
+#include "metrics.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <type_traits>
+
+/** Accumulator of the inner products : exact integers for quantized values. */
+typedef std::conditional<std::is_integral<PreferenceValue>::value, uint64_t, double>::type GramSum;
+
+bool gramDistances(const PreferenceMatrix &space,
+                   DistanceMatrix &distances,
+                   unsigned long depth,
+                   const LinkageBudget &budget) {
+    assert(distances.size() == space.rows());
+    assert(depth > 0);
+    TRACE_SCOPE_ARG("gram matrix", "rows", space.rows());
+
+    const unsigned long n = space.rows();
+    const unsigned long m = space.cols();
+    const unsigned long B = DISTANCE_BLOCK_SIZE;
+    const unsigned long cachedBlocks = (distances.cachedRows() + B - 1)/B;
+    const unsigned long nBlocks = (n + B - 1)/B;
+
+    // squared norms of the rows
+    std::vector<GramSum> norms(n, 0);
+
+    #pragma omp parallel for
+    for(long i = 0; i < static_cast<long>(n); i++) {
+        auto pf = space.row(i);
+        GramSum norm = 0;
+        for(unsigned long k = 0; k < m; k++) {
+            norm += GramSum(pf[k])*pf[k];
+        }
+        norms[i] = norm;
+    }
+
+    // tiles of the cached rows of tiles, on and above the diagonal
+    std::vector<std::pair<unsigned long, unsigned long>> tiles;
+    for(unsigned long bi = 0; bi < cachedBlocks; bi++) {
+        for(unsigned long bj = bi; bj < nBlocks; bj++) {
+            tiles.emplace_back(bi, bj);
+        }
+    }
+
+    // distances set and preference values read by the tiles
+    unsigned long evaluations = 0;
+    unsigned long values = n*m;
+    std::atomic<bool> expired {false};
+
+    #pragma omp parallel reduction(+:evaluations, values)
+    {
+        std::vector<GramSum> products(B*B);
+        std::vector<PreferenceValue> packed(depth*B);
+
+        #pragma omp for schedule(dynamic)
+        for(long t = 0; t < static_cast<long>(tiles.size()); t++) {
+            if(expired.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            if(budget.expired()) {
+                expired.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            const unsigned long i0 = tiles[t].first*B;
+            const unsigned long j0 = tiles[t].second*B;
+            const unsigned long rows = std::min(B, n - i0);
+            const unsigned long cols = std::min(B, n - j0);
+
+            std::fill(products.begin(), products.end(), 0);
+
+            for(unsigned long k0 = 0; k0 < m; k0 += depth) {
+                const unsigned long k1 = std::min(m, k0 + depth);
+                values += (rows + cols)*(k1 - k0);
+
+                // models of the block, 1 line of B values per model (missing rows are 0)
+                std::fill(packed.begin(), packed.end(), 0);
+                for(unsigned long jj = 0; jj < cols; jj++) {
+                    auto pf = space.row(j0 + jj);
+                    for(unsigned long k = k0; k < k1; k++) {
+                        packed[(k - k0)*B + jj] = pf[k];
+                    }
+                }
+
+                for(unsigned long ii = 0; ii < rows; ii++) {
+                    auto pf = space.row(i0 + ii);
+                    auto line = products.data() + ii*B;
+                    for(unsigned long k = k0; k < k1; k++) {
+                        if(pf[k] <= 0) {
+                            continue;
+                        }
+                        const GramSum a = pf[k];
+                        const PreferenceValue *b = packed.data() + (k - k0)*B;
+
+                        #pragma omp simd
+                        for(unsigned long jj = 0; jj < B; jj++) {
+                            line[jj] += a*b[jj];
+                        }
+                    }
+                }
+            }
+
+            for(unsigned long ii = 0; ii < rows; ii++) {
+                for(unsigned long jj = 0; jj < cols; jj++) {
+                    const unsigned long i = i0 + ii;
+                    const unsigned long j = j0 + jj;
+                    if(i < j) {
+                        distances.set(i, j, tanimotoFromSums(norms[i], norms[j], products[ii*B + jj]));
+                        evaluations++;
+                    }
+                }
+            }
+        }
+    }
+    METRICS_COUNT(Counter::DISTANCE_EVALUATIONS, evaluations);
+    METRICS_COUNT(Counter::BYTES_TOUCHED, values*sizeof(PreferenceValue));
+    return !expired;
+}
@@ -1,4 +1,8 @@
 #include "image.h"
+#include "scalespace.h"
+#include "trace.h"
+
+#include <numeric>
 
 bool loadImage(const std::string &path, cv::Mat &image) {
     std::cout << "loading image ..." << std::endl;
@@ -25,22 +29,27 @@ bool loadImage(const std::string &path, cv::Mat &image) {
 
 
 void contourSobel(cv::Mat &image) {
+    cv::Mat gradX, gradY;
+    contourSobel(image, gradX, gradY);
+}
+
+void contourSobel(cv::Mat &image, cv::Mat &gradX, cv::Mat &gradY) {
     cv::cvtColor(image, image, cv::COLOR_RGB2GRAY);
     cv::GaussianBlur(image, image, cv::Size(7, 7), 0);
 
-    cv::Mat sobelX, sobelY;
     cv::Mat absSobelX, absSobelY;
 
-    cv::Sobel(image, sobelX, CV_16S, 1, 0);
-    cv::Sobel(image, sobelY, CV_16S, 0, 1);
+    cv::Sobel(image, gradX, CV_32F, 1, 0);
+    cv::Sobel(image, gradY, CV_32F, 0, 1);
 
-    cv::convertScaleAbs(sobelX, absSobelX);
-    cv::convertScaleAbs(sobelY, absSobelY);
+    cv::convertScaleAbs(gradX, absSobelX);
+    cv::convertScaleAbs(gradY, absSobelY);
 
     cv::addWeighted(absSobelX, 0.5, absSobelY, 0.5, 0, image);
 }
 
 void contourCanny(cv::Mat &image) {
+    TRACE_SCOPE("contourCanny");
     cv::Mat out, edges;
     out.create(image.size(), image.type());
 
@@ -55,41 +64,109 @@ void contourCanny(cv::Mat &image) {
 
 }
 
-unsigned char getAveragePixelValueFrom(const cv::Mat &image) {
+void computeGradients(const cv::Mat &image, cv::Mat &gradX, cv::Mat &gradY) {
+    TRACE_SCOPE("computeGradients");
+    cv::Mat grey;
     if(image.channels() == 3) {
-        cv::cvtColor(image, image, cv::COLOR_RGB2GRAY);
+        cv::cvtColor(image, grey, cv::COLOR_RGB2GRAY);
+    }
+    else {
+        grey = image;
     }
+    cv::GaussianBlur(grey, grey, cv::Size(7, 7), 0);
 
-    auto sum = 0.;
-    for(int i = 0; i < image.rows; i++) {
-        for(int j = 0; j < image.cols; j++) {
-            sum += image.at<uchar>(i, j);
-        }
+    cv::Sobel(grey, gradX, CV_32F, 1, 0);
+    cv::Sobel(grey, gradY, CV_32F, 0, 1);
+}
+
+unsigned char getAveragePixelValueFrom(const cv::Mat &image) {
+    if(image.channels() == 3) {
+        cv::Mat grey;
+        cv::cvtColor(image, grey, cv::COLOR_RGB2GRAY);
+        return cv::mean(grey)[0];
     }
-    return sum / (image.rows * image.cols);
+    return cv::mean(image)[0];
 }
 
 PointPool extractPointsFromImage(const cv::Mat &image) {
-    PointPool points;
+    return extractPointsFromImage(image, cv::Mat(), cv::Mat());
+}
 
-    auto threshold = getAveragePixelValueFrom(image);
+PointPool extractPointsFromImage(const cv::Mat &image, const cv::Mat &gradX, const cv::Mat &gradY, int stride) {
+    double threshold = EDGE_THRESHOLD_FACTOR*getAveragePixelValueFrom(image);
+    return extractPointsFromImage(image, gradX, gradY, cv::Rect(0, 0, image.cols, image.rows), threshold, stride);
+}
 
-    for(auto i = 0; i < image.rows; i ++) {
-        for(auto j = 0; j < image.cols; j++) {
-            if(image.at<uchar>(i, j) > 3*threshold) {
-                auto x = j/static_cast<double>(image.cols);
-                auto y = i/static_cast<double>(image.rows);
+PointPool extractPointsFromImage(const cv::Mat &image,
+                                 const cv::Mat &gradX,
+                                 const cv::Mat &gradY,
+                                 const cv::Rect &roi,
+                                 double threshold,
+                                 int stride) {
+    TRACE_SCOPE("extractPointsFromImage");
+    assert(stride >= 1);
+    assert(roi.x >= 0 && roi.y >= 0 && roi.x + roi.width <= image.cols && roi.y + roi.height <= image.rows);
+
+    cv::Mat grey;
+    if(image.channels() == 3) {
+        cv::cvtColor(image(roi), grey, cv::COLOR_RGB2GRAY);
+    }
+    else {
+        grey = image(roi);
+    }
 
-                // round to limit the number of points that we save
-//                x = std::round(x * ROUND_VALUE)/ROUND_VALUE;
-//                y = std::round(y * ROUND_VALUE)/ROUND_VALUE;
+    bool withGradient = !gradX.empty() && !gradY.empty();
+    assert(!withGradient || (gradX.size() == image.size() && gradY.size() == image.size()));
 
-                Point p =  Point(x, y);
-                points.insert(p, FILTER_VALUE);
+    cv::Mat mask = grey > threshold;
+
+    // first pass : count contour pixels of each row
+    std::vector<int> rowOffsets(mask.rows + 1, 0);
+
+    #pragma omp parallel for
+    for(int i = 0; i < mask.rows; i++) {
+        rowOffsets[i + 1] = cv::countNonZero(mask.row(i));
+    }
+    std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+
+    // raster index k is kept if k % stride == 0, so we know the final size
+    auto nPoints = (rowOffsets[mask.rows] + stride - 1) / stride;
+    std::vector<std::shared_ptr<Point>> buffer(nPoints);
+
+    // second pass : each row writes its kept points in its own slots
+    double cols = image.cols;
+    double rows = image.rows;
+
+    #pragma omp parallel for
+    for(int i = 0; i < mask.rows; i++) {
+        const uchar *maskRow = mask.ptr<uchar>(i);
+        const float *gxRow = withGradient ? gradX.ptr<float>(i + roi.y) + roi.x : nullptr;
+        const float *gyRow = withGradient ? gradY.ptr<float>(i + roi.y) + roi.x : nullptr;
+        auto k = rowOffsets[i]; // raster index of the next contour pixel
+
+        for(int j = 0; j < mask.cols; j++) {
+            if(!maskRow[j]) {
+                continue;
+            }
+            if(k % stride == 0) {
+                auto x = (j + roi.x)/cols;
+                auto y = (i + roi.y)/rows;
+
+                if(withGradient) {
+                    // gradients are covectors : going to the [0, 1]x[0, 1] frame
+                    // multiplies each component by the corresponding image dimension
+                    double magnitude = std::hypot(gxRow[j], gyRow[j]);
+                    double orientation = std::atan2(gyRow[j]*rows, gxRow[j]*cols);
+                    buffer[k / stride] = std::make_shared<Point>(x, y, magnitude, orientation);
+                }
+                else {
+                    buffer[k / stride] = std::make_shared<Point>(x, y);
+                }
             }
+            k++;
         }
     }
-    return points;
+    return PointPool(std::move(buffer));
 }
 
 void drawLineOnImage(cv::Mat &image, Line line) {
@@ -124,9 +201,10 @@ cv::Mat dog(const cv::Mat &image, int k1, int k2) {
 std::vector<cv::Mat> successiveDoG(const cv::Mat &image, int n) {
     std::vector<cv::Mat> dogs;
 
-    for(struct {int i, j;} loop = {1, 0}; loop.j < n; loop.i+=2, loop.j++) {
-        std::cout << "kernel of size " << loop.i << std::endl;
-        dogs.emplace_back(dog(image, loop.i, loop.i+2));
+    // 1 incremental blur per level instead of 2 blurs of the original image
+    ScaleSpace space(image, n + 1);
+    for(int l = 0; l < n; l++) {
+        dogs.emplace_back(space.dog(l));
     }
 
     return dogs;
@@ -1,4 +1,5 @@
 #include "line.h"
+#include "moments.h"
 
 Line::Line() {}
 
@@ -76,14 +77,16 @@ double Line::squaredLength() {
 }
 
 std::vector<Line> Line::drawModels(unsigned int n, const PointPool &dataSet) {
-    assert(N_MODELS_TO_DRAW <= dataSet.size());
+    assert(n <= dataSet.size());
 
     std::vector<Line> models; // our set of clusters
 
     int index = 0;
+    unsigned int attempts = 0;
 
-    // building clusters until no more points in data set
-    while(models.size()  < N_MODELS_TO_DRAW) {
+    // building clusters until no more points in data set (collinear points give
+    // the same line again and again : we give up after a while, as with gradients)
+    while(models.size()  < n && attempts++ < 10*n) {
         auto insert = true;
 
         // retrieve a first new random point from data set
@@ -118,6 +121,69 @@ std::vector<Line> Line::drawModels(unsigned int n, const PointPool &dataSet) {
 }
 
 
+Line Line::fromGradient(const Point &p) {
+    assert(p.hasGradient());
+
+    // contour direction is orthogonal to the gradient
+    double dx = -std::sin(p.gradientOrientation());
+    double dy = std::cos(p.gradientOrientation());
+
+    return Line(p, Point(p.x() + dx, p.y() + dy));
+}
+
+std::vector<Line> Line::drawModelsFromGradients(unsigned int n, const PointPool &dataSet, bool refine) {
+    std::vector<std::shared_ptr<Point>> candidates;
+    for(const auto &point : dataSet.points()) {
+        if(point->hasGradient()) {
+            candidates.emplace_back(point);
+        }
+    }
+    assert(n <= candidates.size());
+
+    std::vector<Line> models;
+    unsigned int attempts = 0;
+
+    // a contour gives the same model for most of its points, so we give up
+    // after a while instead of looping forever on simple images
+    while(models.size() < n && attempts++ < 10*n) {
+        auto insert = true;
+        const auto &p = *candidates[std::rand() % candidates.size()];
+
+        auto model = fromGradient(p);
+
+        if(refine) {
+            // short baseline refinement : principal axis of the close points
+            // sharing the orientation of p
+            Moments moments;
+
+            for(const auto &q : candidates) {
+                auto dTheta = std::remainder(q->gradientOrientation() - p.gradientOrientation(), M_PI);
+                if(std::abs(dTheta) < GRADIENT_ANGLE_TOLERANCE
+                        && squaredDistance(p, *q) < GRADIENT_REFINEMENT_RADIUS*GRADIENT_REFINEMENT_RADIUS) {
+                    moments.add(*q);
+                }
+            }
+
+            if(moments.n() >= 3) {
+                model = moments.fitLine();
+            }
+        }
+
+        for(auto line : models) {
+            if(model == line) {
+                insert = false;
+            }
+        }
+
+        if(insert) {
+            models.emplace_back(model);
+        }
+    }
+    std::cout<< "[DEBUG] End of gradient sampling. Generated "
+             << models.size()  << " models for total data of size  : " << dataSet.size() << std::endl;
+    return models;
+}
+
 std::set<Point> Line::generateRandomInliers(unsigned int n) {
     std::set<Point> inliers;
     for(int i = 0; i < n; i++) {
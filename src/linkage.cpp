@@ -0,0 +1,348 @@
+#include "linkage.h"
+#include "gram.h"
+#include "metrics.h"
+#include "trace.h"
+
+#include <atomic>
+
+/**
+ * Fills the distance cache pair by pair.
+ *
+ * @return false if the budget expired before all rows were filled
+ */
+template<typename Space>
+static bool fillDistanceCache(const Space &space, DistanceMatrix &distances, const LinkageBudget &budget) {
+    const long n = distances.size();
+    unsigned long evaluations = 0;
+    std::atomic<bool> expired {false};
+
+    // rows are shorter and shorter
+    #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+    for(long i = 0; i < static_cast<long>(distances.cachedRows()); i++) {
+        if(expired.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if(budget.expired()) {
+            expired.store(true, std::memory_order_relaxed);
+            continue;
+        }
+        for(long j = i + 1; j < n; j++) {
+            distances.set(i, j, space.distance(i, j));
+        }
+        evaluations += n - i - 1;
+    }
+    METRICS_COUNT(Counter::DISTANCE_EVALUATIONS, evaluations);
+    METRICS_COUNT(Counter::BYTES_TOUCHED, evaluations*2*(space.bytes()/std::max(1L, n)));
+    return !expired;
+}
+
+#if GRAM_INITIALISATION
+/** Singletons only differ by their preference functions : all distances follow from P.P^T. */
+static bool fillDistanceCache(const PreferenceMatrix &space, DistanceMatrix &distances, const LinkageBudget &budget) {
+    return gramDistances(space, distances, GRAM_BLOCK_DEPTH, budget);
+}
+#endif
+
+template<typename Space>
+Linkage<Space>::Linkage(const std::vector<Cluster> &clusters,
+                        const Space &space,
+                        size_t memoryBudget,
+                        const LinkageBudget &budget) :
+    _clusters {clusters},
+    _next(clusters.size(), -1),
+    _last(clusters.size()),
+    _sizes(clusters.size()),
+    _moments(clusters.size()),
+    _space {space},
+    _distances(clusters.size(), memoryBudget),
+    _active(clusters.size(), 1),
+    _nearest(clusters.size(), -1),
+    _nearestDistance(clusters.size(), 1.f),
+    _row(clusters.size(), 1.f),
+    _size {clusters.size()},
+    _interrupted {false},
+    _interval {0},
+    _start {std::chrono::steady_clock::now()},
+    _lastReport {_start} {
+    TRACE_SCOPE_ARG("linkage setup", "clusters", clusters.size());
+    assert(space.rows() == clusters.size());
+
+    const long n = _size;
+
+    for(long i = 0; i < n; i++) {
+        _last[i] = i;
+        _sizes[i] = _clusters[i].points().size();
+        _moments[i] = _clusters[i].moments();
+    }
+
+    {
+        TRACE_SCOPE("distance cache");
+        _interrupted = !fillDistanceCache(_space, _distances, budget);
+    }
+
+    // distances of the uncached rows
+    unsigned long evaluations = 0;
+    std::atomic<bool> expired {_interrupted};
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+    for(long i = 0; i < n; i++) {
+        if(expired.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if(budget.expired()) {
+            expired.store(true, std::memory_order_relaxed);
+            continue;
+        }
+        evaluations += updateNearest(i);
+    }
+    _interrupted = expired;
+
+    _peakMemory = _space.bytes() + _distances.bytes()
+            + _clusters.size()*(sizeof(char) + 3*sizeof(long) + sizeof(unsigned long)
+                                + sizeof(Moments) + 2*sizeof(float));
+
+    METRICS_COUNT(Counter::DISTANCE_EVALUATIONS, evaluations);
+    METRICS_COUNT(Counter::BYTES_TOUCHED, evaluations*2*(_space.bytes()/std::max(1L, n)));
+
+    std::cout << "[DEBUG] Linkage distance cache : " << _distances.cachedRows() << "/" << n
+              << " rows, " << _distances.bytes()/(1024*1024) << " MB." << std::endl;
+    if(_interrupted) {
+        std::cout << "[DEBUG] Linkage setup interrupted by its budget, no clusters will be linked." << std::endl;
+    }
+}
+
+template<typename Space>
+void Linkage<Space>::addObserver(ProgressObserver *observer, double interval) {
+    assert(observer);
+    _observers.emplace_back(observer);
+    _interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(interval));
+    _progress.labels.resize(_clusters.size());
+}
+
+template<typename Space>
+bool Linkage<Space>::step() {
+    TRACE_SCOPE_ARG("linkage round", "clusters", _size);
+    // nearest neighbours are unknown
+    if(_interrupted) {
+        return false;
+    }
+
+    // find closest clusters
+    long a = -1;
+    float minDist = 1.f;
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i] && _nearestDistance[i] < minDist) {
+            minDist = _nearestDistance[i];
+            a = i;
+        }
+    }
+    if(a < 0) {
+        finish();
+        return false;
+    }
+    long b = _nearest[a];
+
+    // the second cluster should be the smallest for faster merging
+    if(_sizes[a] < _sizes[b]) {
+        std::swap(a, b);
+    }
+
+    // merge b into a
+    _next[_last[a]] = b;
+    _last[a] = _last[b];
+    _sizes[a] += _sizes[b];
+    _moments[a].merge(_moments[b]);
+    _active[b] = 0;
+    _size--;
+    _progress.merges++;
+    _progress.distance = minDist;
+
+    _space.merge(a, b);
+    TRACE_COUNTER("clusters", _size);
+
+    const long n = _clusters.size();
+
+    // new distances to the merged cluster
+    unsigned long evaluations = 0;
+
+    #pragma omp parallel for reduction(+:evaluations)
+    for(long k = 0; k < n; k++) {
+        if(_active[k] && k != a) {
+            _row[k] = computeDistance(a, k);
+            _distances.set(a, k, _row[k]);
+            evaluations++;
+        }
+    }
+
+    // update nearest neighbours
+    unsigned long rescans = 0;
+    unsigned long rescanEvaluations = 0;
+
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:rescans, rescanEvaluations)
+    for(long k = 0; k < n; k++) {
+        if(!_active[k]) {
+            continue;
+        }
+        if(k == a || _nearest[k] == a || _nearest[k] == b) {
+            rescanEvaluations += updateNearest(k);
+            rescans++;
+        }
+        else if(_row[k] < _nearestDistance[k] || (_row[k] == _nearestDistance[k] && a < _nearest[k])) {
+            _nearest[k] = a;
+            _nearestDistance[k] = _row[k];
+        }
+    }
+
+#ifdef TLK_METRICS
+    // a full scan (see link()) compares all pairs, we only compare the rows of the
+    // merged cluster and of the clusters that lost their nearest neighbour, reading
+    // the cached distances and computing the others
+    unsigned long pairs = _size*(_size - 1)/2;
+    unsigned long evaluated = std::min(pairs, (1 + rescans)*(_size - 1));
+    unsigned long computed = evaluations + rescanEvaluations;
+    Metrics::add(Counter::MERGES, 1);
+    Metrics::add(Counter::DISTANCE_EVALUATIONS, computed);
+    Metrics::add(Counter::PRUNED_PAIRS, pairs - evaluated);
+    Metrics::add(Counter::BYTES_TOUCHED, computed*2*(_space.bytes()/_clusters.size())
+                                        + (rescans*(_size - 1) - rescanEvaluations)*sizeof(float));
+#endif
+
+    if(!_observers.empty() && std::chrono::steady_clock::now() - _lastReport >= _interval) {
+        report(false);
+    }
+    return true;
+}
+
+template<typename Space>
+int Linkage<Space>::run() {
+    int linkages = 0;
+    while(step()) {
+        linkages++;
+    }
+    return linkages;
+}
+
+template<typename Space>
+void Linkage<Space>::finish() {
+    if(!_observers.empty() && !_progress.finished) {
+        report(true);
+    }
+}
+
+template<typename Space>
+std::vector<Cluster> Linkage<Space>::clusters() const {
+    std::vector<Cluster> clusters;
+    clusters.reserve(_size);
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i]) {
+            Cluster cluster;
+            for(long k = i; k >= 0; k = _next[k]) {
+                cluster.merge(_clusters[k]);
+            }
+            clusters.emplace_back(cluster);
+        }
+    }
+    return clusters;
+}
+
+template<typename Space>
+const Moments &Linkage<Space>::moments(unsigned long row) const {
+    return _moments[row];
+}
+
+template<typename Space>
+const Space &Linkage<Space>::space() const {
+    return _space;
+}
+
+template<typename Space>
+std::vector<unsigned long> Linkage<Space>::activeRows() const {
+    std::vector<unsigned long> rows;
+    rows.reserve(_size);
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i]) {
+            rows.emplace_back(i);
+        }
+    }
+    return rows;
+}
+
+template<typename Space>
+unsigned long Linkage<Space>::size() const {
+    return _size;
+}
+
+template<typename Space>
+bool Linkage<Space>::interrupted() const {
+    return _interrupted;
+}
+
+template<typename Space>
+unsigned long Linkage<Space>::cachedRows() const {
+    return _distances.cachedRows();
+}
+
+template<typename Space>
+size_t Linkage<Space>::peakMemory() const {
+    return _peakMemory;
+}
+
+template<typename Space>
+float Linkage<Space>::computeDistance(unsigned long i, unsigned long j) const {
+    return _space.distance(i, j);
+}
+
+template<typename Space>
+float Linkage<Space>::distance(unsigned long i, unsigned long j) const {
+    return _distances.isCached(i, j) ? _distances.get(i, j) : computeDistance(i, j);
+}
+
+template<typename Space>
+unsigned long Linkage<Space>::updateNearest(unsigned long i) {
+    _nearest[i] = -1;
+    _nearestDistance[i] = 1.f;
+    unsigned long evaluations = 0;
+
+    for(unsigned long j = 0; j < _clusters.size(); j++) {
+        if(!_active[j] || j == i) {
+            continue;
+        }
+        evaluations += !_distances.isCached(i, j);
+        auto d = distance(i, j);
+        if(d < _nearestDistance[i]) {
+            _nearestDistance[i] = d;
+            _nearest[i] = j;
+        }
+    }
+    return evaluations;
+}
+
+template<typename Space>
+void Linkage<Space>::report(bool finished) {
+    TRACE_SCOPE("linkage snapshot");
+    auto now = std::chrono::steady_clock::now();
+
+    // the first initial cluster of a chain is the row of the cluster
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i]) {
+            for(long k = i; k >= 0; k = _next[k]) {
+                _progress.labels[k] = i;
+            }
+        }
+    }
+    _progress.clusters = _size;
+    _progress.seconds = std::chrono::duration<double>(now - _start).count();
+    _progress.finished = finished;
+
+    for(auto observer : _observers) {
+        observer->notify(_progress);
+    }
+    _lastReport = now;
+}
+
+template class Linkage<PreferenceMatrix>;
+template class Linkage<ConsensusMatrix>;
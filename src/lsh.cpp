@@ -0,0 +1,363 @@
+#include "lsh.h"
+#include "trace.h"
+
+#include <atomic>
+#include <map>
+#include <random>
+
+SimHashIndex::SimHashIndex() :
+    _cols {0},
+    _bands {0},
+    _rows {0} {}
+
+SimHashIndex::SimHashIndex(unsigned long cols, unsigned int bands, unsigned int rows, unsigned int seed) :
+    _cols {cols},
+    _bands {bands},
+    _rows {rows},
+    _planes(cols*bands*rows),
+    _buckets(bands) {
+    assert(bands > 0 && bands <= 64 && rows > 0 && rows <= 64);
+
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> normal;
+    for(auto &value : _planes) {
+        value = normal(gen);
+    }
+}
+
+std::vector<uint64_t> SimHashIndex::signature(const PreferenceValue *pf) const {
+    const unsigned long bits = _bands*_rows;
+    std::vector<double> projections(bits, 0.);
+
+    // preference functions are sparse : only the non zero values contribute
+    for(unsigned long m = 0; m < _cols; m++) {
+        if(pf[m] <= 0) {
+            continue;
+        }
+        auto value = PreferencePrecision::load(pf[m]);
+        auto plane = _planes.data() + m*bits;
+        for(unsigned long k = 0; k < bits; k++) {
+            projections[k] += value*plane[k];
+        }
+    }
+
+    std::vector<uint64_t> keys(_bands, 0);
+    for(unsigned int band = 0; band < _bands; band++) {
+        for(unsigned int r = 0; r < _rows; r++) {
+            keys[band] |= uint64_t(projections[band*_rows + r] > 0.) << r;
+        }
+    }
+    return keys;
+}
+
+void SimHashIndex::insert(unsigned long id, const PreferenceValue *pf) {
+    if(std::all_of(pf, pf + _cols, [](PreferenceValue value) { return value <= 0; })) {
+        return;
+    }
+    auto keys = signature(pf);
+    for(unsigned int band = 0; band < _bands; band++) {
+        _buckets[band][keys[band]].emplace_back(id);
+    }
+    _keys[id] = std::move(keys);
+}
+
+void SimHashIndex::remove(unsigned long id) {
+    auto it = _keys.find(id);
+    if(it == _keys.end()) {
+        return;
+    }
+    for(unsigned int band = 0; band < _bands; band++) {
+        auto bucket = _buckets[band].find(it->second[band]);
+        auto &ids = bucket->second;
+        ids.erase(std::find(ids.begin(), ids.end(), id));
+        if(ids.empty()) {
+            _buckets[band].erase(bucket);
+        }
+    }
+    _keys.erase(it);
+}
+
+unsigned long SimHashIndex::size() const {
+    return _keys.size();
+}
+
+size_t SimHashIndex::bytes() const {
+    return _planes.size()*sizeof(float)
+            + _keys.size()*_bands*(2*sizeof(uint64_t) + sizeof(unsigned long));
+}
+
+LshLinkage::LshLinkage(const std::vector<Cluster> &clusters,
+                       const PreferenceMatrix &space,
+                       unsigned int bands,
+                       unsigned int rows,
+                       const LinkageBudget &budget) :
+    _clusters {clusters},
+    _next(clusters.size(), -1),
+    _last(clusters.size()),
+    _sizes(clusters.size()),
+    _space {space},
+    _index(space.cols(), bands, rows),
+    _active(clusters.size(), 1),
+    _nearest(clusters.size(), -1),
+    _nearestDistance(clusters.size(), 1.f),
+    _size {clusters.size()},
+    _interrupted {false} {
+    TRACE_SCOPE_ARG("lsh linkage setup", "clusters", clusters.size());
+    assert(space.rows() == clusters.size());
+
+    const long n = _size;
+
+    for(long i = 0; i < n; i++) {
+        _last[i] = i;
+        _sizes[i] = _clusters[i].points().size();
+    }
+    for(long i = 0; i < n && !_interrupted; i++) {
+        _index.insert(i, _space.row(i));
+        _interrupted = budget.expired();
+    }
+
+    std::atomic<bool> expired {_interrupted};
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(long i = 0; i < n; i++) {
+        if(expired.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if(budget.expired()) {
+            expired.store(true, std::memory_order_relaxed);
+            continue;
+        }
+        updateNearest(i);
+    }
+    _interrupted = expired;
+
+    _peakMemory = _space.bytes() + _index.bytes()
+            + _clusters.size()*(sizeof(char) + 3*sizeof(long) + sizeof(unsigned long) + sizeof(float));
+
+    std::cout << "[DEBUG] LSH linkage : " << _index.size() << "/" << n << " indexed clusters, "
+              << bands << " bands of " << rows << " bits." << std::endl;
+    if(_interrupted) {
+        std::cout << "[DEBUG] LSH linkage setup interrupted by its budget, no clusters will be linked." << std::endl;
+    }
+}
+
+bool LshLinkage::step() {
+    TRACE_SCOPE_ARG("lsh linkage round", "clusters", _size);
+    // nearest neighbours are unknown
+    if(_interrupted) {
+        return false;
+    }
+
+    // find closest clusters
+    long a = -1;
+    float minDist = 1.f;
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i] && _nearestDistance[i] < minDist) {
+            minDist = _nearestDistance[i];
+            a = i;
+        }
+    }
+    if(a < 0) {
+        return false;
+    }
+    long b = _nearest[a];
+
+    // the second cluster should be the smallest for faster merging
+    if(_sizes[a] < _sizes[b]) {
+        std::swap(a, b);
+    }
+
+    // merge b into a
+    _next[_last[a]] = b;
+    _last[a] = _last[b];
+    _sizes[a] += _sizes[b];
+    _active[b] = 0;
+    _size--;
+
+    // the merged cluster is hashed again
+    _index.remove(a);
+    _index.remove(b);
+    _space.merge(a, b);
+    _index.insert(a, _space.row(a));
+
+    const long n = _clusters.size();
+
+    // clusters that lost their nearest neighbour
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(long k = 0; k < n; k++) {
+        if(_active[k] && (k == a || _nearest[k] == a || _nearest[k] == b)) {
+            updateNearest(k);
+        }
+    }
+
+    // candidates of the merged cluster may now prefer it
+    _index.forEachCandidate(a, [&](unsigned long k) {
+        if(!_active[k]) {
+            return;
+        }
+        float d = _space.distance(a, k);
+        if(d < _nearestDistance[k] || (d == _nearestDistance[k] && a < _nearest[k])) {
+            _nearest[k] = a;
+            _nearestDistance[k] = d;
+        }
+    });
+    return true;
+}
+
+int LshLinkage::run() {
+    int linkages = 0;
+    while(step()) {
+        linkages++;
+    }
+    return linkages;
+}
+
+void LshLinkage::finish() {}
+
+std::vector<Cluster> LshLinkage::clusters() const {
+    std::vector<Cluster> clusters;
+    clusters.reserve(_size);
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i]) {
+            Cluster cluster;
+            for(long k = i; k >= 0; k = _next[k]) {
+                cluster.merge(_clusters[k]);
+            }
+            clusters.emplace_back(cluster);
+        }
+    }
+    return clusters;
+}
+
+const PreferenceMatrix &LshLinkage::space() const {
+    return _space;
+}
+
+std::vector<unsigned long> LshLinkage::activeRows() const {
+    std::vector<unsigned long> rows;
+    rows.reserve(_size);
+
+    for(unsigned long i = 0; i < _clusters.size(); i++) {
+        if(_active[i]) {
+            rows.emplace_back(i);
+        }
+    }
+    return rows;
+}
+
+unsigned long LshLinkage::size() const {
+    return _size;
+}
+
+bool LshLinkage::interrupted() const {
+    return _interrupted;
+}
+
+size_t LshLinkage::peakMemory() const {
+    return _peakMemory;
+}
+
+void LshLinkage::updateNearest(unsigned long i) {
+    _nearest[i] = -1;
+    _nearestDistance[i] = 1.f;
+
+    // smallest index wins ties, whatever the order of the buckets
+    _index.forEachCandidate(i, [&](unsigned long j) {
+        if(!_active[j]) {
+            return;
+        }
+        float d = _space.distance(i, j);
+        if(d < _nearestDistance[i] || (d == _nearestDistance[i] && static_cast<long>(j) < _nearest[i])) {
+            _nearestDistance[i] = d;
+            _nearest[i] = j;
+        }
+    });
+}
+
+double lshRecall(const PreferenceMatrix &space, unsigned int bands, unsigned int rows, unsigned long samples) {
+    const unsigned long n = space.rows();
+    samples = std::min(samples, n);
+
+    SimHashIndex index(space.cols(), bands, rows);
+    for(unsigned long i = 0; i < n; i++) {
+        index.insert(i, space.row(i));
+    }
+
+    long found = 0;
+    long total = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:found, total)
+    for(long s = 0; s < static_cast<long>(samples); s++) {
+        unsigned long i = s*n/samples;
+
+        float exact = 1.f;
+        for(unsigned long j = 0; j < n; j++) {
+            if(j != i) {
+                exact = std::min<float>(exact, space.distance(i, j));
+            }
+        }
+        // rows without any neighbour can not be missed
+        if(exact >= 1.f) {
+            continue;
+        }
+
+        float approximate = 1.f;
+        index.forEachCandidate(i, [&](unsigned long j) {
+            approximate = std::min<float>(approximate, space.distance(i, j));
+        });
+        total++;
+        found += approximate == exact;
+    }
+    return total > 0 ? static_cast<double>(found)/total : 1.;
+}
+
+double clusteringAgreement(const std::vector<Cluster> &clusters1, const std::vector<Cluster> &clusters2) {
+    std::unordered_map<const Point *, unsigned long> labels;
+    for(unsigned long c = 0; c < clusters1.size(); c++) {
+        for(const auto &point : clusters1[c].points()) {
+            labels[point.get()] = c;
+        }
+    }
+
+    // contingency table of the points found in both clusterings
+    std::map<std::pair<unsigned long, unsigned long>, unsigned long> both;
+    std::vector<unsigned long> sizes1(clusters1.size(), 0);
+    std::vector<unsigned long> sizes2(clusters2.size(), 0);
+    unsigned long n = 0;
+
+    for(unsigned long c = 0; c < clusters2.size(); c++) {
+        for(const auto &point : clusters2[c].points()) {
+            auto it = labels.find(point.get());
+            if(it == labels.end()) {
+                continue;
+            }
+            both[{it->second, c}]++;
+            sizes1[it->second]++;
+            sizes2[c]++;
+            n++;
+        }
+    }
+    if(n < 2) {
+        return 1.;
+    }
+
+    auto pairs = [](double k) { return k*(k - 1)/2; };
+    double together = 0.;
+    double together1 = 0.;
+    double together2 = 0.;
+    for(const auto &cell : both) {
+        together += pairs(cell.second);
+    }
+    for(auto size : sizes1) {
+        together1 += pairs(size);
+    }
+    for(auto size : sizes2) {
+        together2 += pairs(size);
+    }
+
+    // pairs together in both + pairs apart in both
+    const double total = pairs(n);
+    return (total + 2*together - together1 - together2)/total;
+}
@@ -0,0 +1,86 @@
+#include "metrics.h"
+#include "allocation.h"
+
+#include <fstream>
+#include <sstream>
+
+std::atomic<unsigned long> Metrics::_counters[static_cast<int>(Counter::COUNT)] {};
+std::atomic<long long> Metrics::_stageNanoseconds[static_cast<int>(Stage::COUNT)] {};
+std::chrono::steady_clock::time_point Metrics::_stageStarts[static_cast<int>(Stage::COUNT)];
+
+static const char *counterNames[] = {
+    "pf_evaluations",
+    "distance_evaluations",
+    "pruned_pairs",
+    "merges",
+    "bytes_touched"
+};
+
+static const char *stageNames[] = {
+    "load",
+    "edge_detection",
+    "extraction",
+    "sampling",
+    "preference",
+    "linkage",
+    "validation",
+    "refinement"
+};
+
+void Metrics::add(Counter counter, unsigned long value) {
+    _counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+unsigned long Metrics::get(Counter counter) {
+    return _counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
+
+void Metrics::startStage(Stage stage) {
+    _stageStarts[static_cast<int>(stage)] = std::chrono::steady_clock::now();
+}
+
+void Metrics::stopStage(Stage stage) {
+    auto elapsed = std::chrono::steady_clock::now() - _stageStarts[static_cast<int>(stage)];
+    _stageNanoseconds[static_cast<int>(stage)].fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                std::memory_order_relaxed);
+}
+
+double Metrics::stageTime(Stage stage) {
+    return _stageNanoseconds[static_cast<int>(stage)].load(std::memory_order_relaxed)/1e6;
+}
+
+std::string Metrics::toJson() {
+    std::ostringstream out;
+    out << "{\n  \"counters\": {\n";
+    for(int i = 0; i < static_cast<int>(Counter::COUNT); i++) {
+        out << "    \"" << counterNames[i] << "\": " << get(static_cast<Counter>(i)) << ",\n";
+    }
+    out << "    \"allocations\": " << allocationCount() << ",\n"
+        << "    \"allocated_bytes\": " << allocatedBytes() << "\n"
+        << "  },\n  \"stages_ms\": {\n";
+    for(int i = 0; i < static_cast<int>(Stage::COUNT); i++) {
+        out << "    \"" << stageNames[i] << "\": " << stageTime(static_cast<Stage>(i))
+            << (i + 1 < static_cast<int>(Stage::COUNT) ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return out.str();
+}
+
+bool Metrics::writeJson(const std::string &path) {
+    std::ofstream file(path);
+    if(!file) {
+        return false;
+    }
+    file << toJson();
+    return static_cast<bool>(file);
+}
+
+StageTimer::StageTimer(Stage stage) :
+    _stage {stage} {
+    Metrics::startStage(stage);
+}
+
+StageTimer::~StageTimer() {
+    Metrics::stopStage(_stage);
+}
@@ -0,0 +1,181 @@
+#include "moments.h"
+
+Moments::Moments() :
+    _n {0.},
+    _x {0.},
+    _y {0.},
+    _xx {0.},
+    _xy {0.},
+    _yy {0.},
+    _xz {0.},
+    _yz {0.},
+    _zz {0.} {}
+
+Moments::Moments(const Point &p) :
+    Moments() {
+    add(p);
+}
+
+void Moments::add(const Point &p) {
+    _n  += 1.;
+    _x  += p.x();
+    _y  += p.y();
+    _xx += p.x()*p.x();
+    _xy += p.x()*p.y();
+    _yy += p.y()*p.y();
+
+    auto z = p.x()*p.x() + p.y()*p.y();
+    _xz += p.x()*z;
+    _yz += p.y()*z;
+    _zz += z*z;
+}
+
+void Moments::merge(const Moments &other) {
+    _n  += other._n;
+    _x  += other._x;
+    _y  += other._y;
+    _xx += other._xx;
+    _xy += other._xy;
+    _yy += other._yy;
+    _xz += other._xz;
+    _yz += other._yz;
+    _zz += other._zz;
+}
+
+double Moments::n() const {
+    return _n;
+}
+
+Point Moments::centroid() const {
+    assert(_n > 0.);
+    return Point(_x/_n, _y/_n);
+}
+
+Line Moments::fitLine() const {
+    assert(_n >= 2.);
+
+    double sxx, sxy, syy;
+    covariance(sxx, sxy, syy);
+
+    // principal axis of the covariance matrix
+    auto angle = 0.5*std::atan2(2*sxy, sxx - syy);
+    auto c = centroid();
+
+    return Line(c, Point(c.x() + std::cos(angle), c.y() + std::sin(angle)));
+}
+
+double Moments::lineResidual() const {
+    double sxx, sxy, syy;
+    covariance(sxx, sxy, syy);
+
+    // smallest eigenvalue of the covariance matrix
+    auto halfTrace = 0.5*(sxx + syy);
+    auto halfDiff = 0.5*(sxx - syy);
+    return std::max(0., halfTrace - std::sqrt(halfDiff*halfDiff + sxy*sxy));
+}
+
+void Moments::covariance(double &sxx, double &sxy, double &syy) const {
+    assert(_n > 0.);
+
+    auto cx = _x/_n;
+    auto cy = _y/_n;
+    sxx = _xx/_n - cx*cx;
+    sxy = _xy/_n - cx*cy;
+    syy = _yy/_n - cy*cy;
+}
+
+void Moments::centeredMoments(double &mxx, double &mxy, double &myy,
+                              double &mxz, double &myz, double &mzz) const {
+    covariance(mxx, mxy, myy);
+
+    auto cx = _x/_n;
+    auto cy = _y/_n;
+    // raw means
+    auto x = cx;
+    auto y = cy;
+    auto xx = _xx/_n;
+    auto xy = _xy/_n;
+    auto yy = _yy/_n;
+    auto z = xx + yy;
+    auto xz = _xz/_n;
+    auto yz = _yz/_n;
+    auto zz = _zz/_n;
+
+    // centered z : zc = z - 2 cx x - 2 cy y + c
+    auto c = cx*cx + cy*cy;
+
+    // mean(xc zc) and mean(yc zc), with xc = x - cx
+    auto xZc = xz - 2*cx*xx - 2*cy*xy + c*x;
+    auto yZc = yz - 2*cx*xy - 2*cy*yy + c*y;
+    auto zcMean = z - 2*cx*x - 2*cy*y + c;
+    mxz = xZc - cx*zcMean;
+    myz = yZc - cy*zcMean;
+
+    // mean(zc^2)
+    mzz = zz + 4*cx*cx*xx + 4*cy*cy*yy + c*c
+            - 4*cx*xz - 4*cy*yz + 2*c*z
+            + 8*cx*cy*xy - 4*c*cx*x - 4*c*cy*y;
+}
+
+Circle Moments::fitCircleKasa() const {
+    assert(_n >= 3.);
+
+    double mxx, mxy, myy, mxz, myz, mzz;
+    centeredMoments(mxx, mxy, myy, mxz, myz, mzz);
+
+    // 2 [mxx mxy; mxy myy] [a; b] = [mxz; myz]
+    auto det = 2*(mxx*myy - mxy*mxy);
+    if(det == 0.) {
+        return Circle(centroid(), 0.);
+    }
+    auto a = (mxz*myy - myz*mxy)/det;
+    auto b = (myz*mxx - mxz*mxy)/det;
+
+    auto c = centroid();
+    return Circle(Point(c.x() + a, c.y() + b), std::sqrt(a*a + b*b + mxx + myy));
+}
+
+Circle Moments::fitCircle() const {
+    assert(_n >= 3.);
+
+    double mxx, mxy, myy, mxz, myz, mzz;
+    centeredMoments(mxx, mxy, myy, mxz, myz, mzz);
+
+    // coefficients of the characteristic polynomial
+    auto mz = mxx + myy;
+    auto covXY = mxx*myy - mxy*mxy;
+    auto varZ = mzz - mz*mz;
+    auto a3 = 4*mz;
+    auto a2 = -3*mz*mz - mzz;
+    auto a1 = varZ*mz + 4*covXY*mz - mxz*mxz - myz*myz;
+    auto a0 = mxz*(mxz*myy - myz*mxy) + myz*(myz*mxx - mxz*mxy) - varZ*covXY;
+    auto a22 = a2 + a2;
+    auto a33 = a3 + a3 + a3;
+
+    // Newton's method starting at x = 0 (converges to the smallest root)
+    double x = 0.;
+    double y = a0;
+    for(int iter = 0; iter < 99; iter++) {
+        auto dy = a1 + x*(a22 + a33*x);
+        auto xNew = x - y/dy;
+        if(xNew == x || !std::isfinite(xNew)) {
+            break;
+        }
+        auto yNew = a0 + xNew*(a1 + xNew*(a2 + xNew*a3));
+        if(std::abs(yNew) >= std::abs(y)) {
+            break;
+        }
+        x = xNew;
+        y = yNew;
+    }
+
+    auto det = x*x - x*mz + covXY;
+    if(det == 0. || !std::isfinite(det)) {
+        return fitCircleKasa();
+    }
+    auto a = (mxz*(myy - x) - myz*mxy)/det/2;
+    auto b = (myz*(mxx - x) - mxz*mxy)/det/2;
+
+    auto c = centroid();
+    return Circle(Point(c.x() + a, c.y() + b), std::sqrt(a*a + b*b + mz));
+}
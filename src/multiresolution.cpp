@@ -0,0 +1,135 @@
+#include "multiresolution.h"
+
+#include <unordered_map>
+
+PointPool stratifiedSubsample(const PointPool &dataSet, unsigned int size) {
+    auto points = dataSet.points();
+    if(points.size() <= size) {
+        return PointPool(std::move(points));
+    }
+
+    // enough cells so that a cell holds ~ 4 subsample points
+    int gridSize = std::max(1, static_cast<int>(std::sqrt(size/4.)));
+    std::vector<std::vector<std::shared_ptr<Point>>> cells(gridSize*gridSize);
+
+    for(const auto &point : points) {
+        auto cx = std::min(gridSize - 1, static_cast<int>(point->x()*gridSize));
+        auto cy = std::min(gridSize - 1, static_cast<int>(point->y()*gridSize));
+        cells[std::max(0, cy)*gridSize + std::max(0, cx)].emplace_back(point);
+    }
+
+    // each cell is walked with the same stride, so it keeps its share of points
+    double stride = static_cast<double>(points.size())/size;
+
+    std::vector<std::shared_ptr<Point>> subsample;
+    subsample.reserve(size + cells.size());
+
+    for(const auto &cell : cells) {
+        for(double k = 0.; k < cell.size(); k += stride) {
+            subsample.emplace_back(cell[static_cast<size_t>(k)]);
+        }
+    }
+    return PointPool(std::move(subsample));
+}
+
+std::vector<Cluster> multiresolutionLinkage(PointPool &dataSet, const std::vector<Line> &models, unsigned int subsampleSize) {
+    auto subsample = stratifiedSubsample(dataSet, subsampleSize);
+
+    // coarse level : full T-Linkage on the subsample
+    auto coarseClusters = Cluster::clusterize(subsample);
+    while(link(coarseClusters, subsample, models)) {}
+
+    std::cout << "[DEBUG] Coarse linkage on " << subsample.size() << " points gave "
+              << coarseClusters.size() << " clusters." << std::endl;
+
+    // fit 1 model per big enough cluster
+    std::vector<Cluster> clusters;
+    std::vector<Line> fittedModels;
+    std::vector<std::vector<double>> clusterPFs;
+
+    for(auto &cluster : coarseClusters) {
+        if(cluster.size() >= MULTIRES_MIN_CLUSTER_SIZE) {
+            fittedModels.emplace_back(cluster.lineModel());
+            clusterPFs.emplace_back(cluster.computePF(models, subsample));
+            clusters.emplace_back(Cluster());
+        }
+    }
+
+    if(clusters.empty()) {
+        return Cluster::clusterize(dataSet);
+    }
+
+    // fine level : each point goes to its closest model, within the PF support
+    const double threshold = 5*TAU;
+    const double margin = MULTIRES_AMBIGUITY_MARGIN*threshold;
+    const long n = dataSet.size();
+
+    std::vector<int> assignment(n, -1);
+    std::vector<char> ambiguous(n, 0);
+
+    #pragma omp parallel for
+    for(long i = 0; i < n; i++) {
+        const auto &point = *dataSet[i];
+        double best = threshold;
+        double second = threshold;
+
+        for(int k = 0; k < static_cast<int>(fittedModels.size()); k++) {
+            auto d = distance(fittedModels[k], point);
+            if(d < best) {
+                second = best;
+                best = d;
+                assignment[i] = k;
+            }
+            else if(d < second) {
+                second = d;
+            }
+        }
+        ambiguous[i] = assignment[i] >= 0 && second < threshold && second - best < margin;
+    }
+
+    // local refinement : ambiguous points are linked to the closest cluster in the
+    // preference space, among the clusters they are close to
+    long nAmbiguous = 0;
+
+    #pragma omp parallel for reduction(+:nAmbiguous)
+    for(long i = 0; i < n; i++) {
+        if(!ambiguous[i]) {
+            continue;
+        }
+        nAmbiguous++;
+
+        const auto &point = *dataSet[i];
+        auto pf = computePreferenceFunctionFor(point, models);
+        double minDist = 1.;
+
+        for(int k = 0; k < static_cast<int>(fittedModels.size()); k++) {
+            if(distance(fittedModels[k], point) >= threshold) {
+                continue;
+            }
+            auto dist = tanimoto(pf, clusterPFs[k]);
+            if(dist < minDist) {
+                minDist = dist;
+                assignment[i] = k;
+            }
+        }
+    }
+
+    std::vector<Cluster> outliers;
+    for(long i = 0; i < n; i++) {
+        if(assignment[i] >= 0) {
+            clusters[assignment[i]].addPoint(dataSet[i]);
+        }
+        else {
+            outliers.emplace_back(Cluster(dataSet[i]));
+        }
+    }
+
+    std::cout << "[DEBUG] Fine assignment : " << n - static_cast<long>(outliers.size()) << " inliers, "
+              << outliers.size() << " outliers, " << nAmbiguous << " ambiguous points re-linked." << std::endl;
+
+    // a model may have lost all its points to its neighbours
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(), [](Cluster &c) {return c.size() == 0;}),
+                   clusters.end());
+    clusters.insert(clusters.end(), outliers.begin(), outliers.end());
+    return clusters;
+}
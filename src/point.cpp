@@ -8,6 +8,12 @@ _y {y} {
     _bestMatchValue = 0.;
 }
 
+Point::Point(double x, double y, double gradientMagnitude, double gradientOrientation) :
+_x {x},
+_y {y},
+_gradientMagnitude {gradientMagnitude},
+_gradientOrientation {gradientOrientation} {}
+
 Point::~Point() {}
 
 void Point::freeAll(std::vector<Point *> &dataSet) {
@@ -57,6 +63,18 @@ bool Point::isInlier() const {
     return _isInlier;
 }
 
+double Point::gradientMagnitude() const {
+    return _gradientMagnitude;
+}
+
+double Point::gradientOrientation() const {
+    return _gradientOrientation;
+}
+
+bool Point::hasGradient() const {
+    return _gradientMagnitude > 0.;
+}
+
 Point Point::randomlyGenerated() {
     double x = randomCoordinate();
     double y = randomCoordinate();
@@ -1,7 +1,12 @@
 #include "pointpool.h"
 
+#include <numeric>
+
 PointPool::PointPool() {}
 
+PointPool::PointPool(std::vector<std::shared_ptr<Point>> &&points) :
+    _points {std::move(points)} {}
+
 PointPool::~PointPool() {};
 
 bool PointPool::insert(const Point &p) {
@@ -16,6 +21,9 @@ bool PointPool::insert(const Point &p) {
     }
 
     _points.emplace_back(std::make_shared<Point>(p));
+    if(!_originalIndices.empty()) {
+        _originalIndices.emplace_back(_nextOriginalIndex++);
+    }
     return true;
 }
 
@@ -34,6 +42,9 @@ bool PointPool::insert(const Point &p, int filterValue) {
     }
 
     _points.emplace_back(std::make_shared<Point>(p));
+    if(!_originalIndices.empty()) {
+        _originalIndices.emplace_back(_nextOriginalIndex++);
+    }
     return true;
 }
 
@@ -64,6 +75,9 @@ std::shared_ptr<Point> PointPool::retrievePointAt(unsigned int pos) {
     auto it = _points.begin() + pos;
     auto returnValue = *it;
     _points.erase(it);
+    if(!_originalIndices.empty()) {
+        _originalIndices.erase(_originalIndices.begin() + pos);
+    }
     return returnValue;
 }
 
@@ -74,3 +88,78 @@ std::vector<std::shared_ptr<Point>>::iterator PointPool::begin() {
 std::vector<std::shared_ptr<Point>>::iterator PointPool::end() {
     return _points.end();
 }
+
+/** Interleaves the bits of x and y (x in the even bits). */
+static uint32_t mortonCode(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+/** Distance along the Hilbert curve of the cell (x, y) of a side x side grid. */
+static uint32_t hilbertCode(uint32_t x, uint32_t y, uint32_t side) {
+    uint32_t d = 0;
+    for(uint32_t s = side/2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += s*s*((3*rx) ^ ry);
+
+        // rotate the quadrant
+        if(ry == 0) {
+            if(rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+const std::vector<unsigned long> &PointPool::sortAlongCurve(SpaceFillingCurve curve) {
+    const unsigned long n = _points.size();
+    const uint32_t side = 1 << 16; // grid of the curve over [0, 1]x[0, 1]
+    std::vector<uint32_t> codes(n);
+
+    #pragma omp parallel for
+    for(long i = 0; i < static_cast<long>(n); i++) {
+        auto x = static_cast<uint32_t>(std::min(std::max(_points[i]->x(), 0.), 1.)*(side - 1));
+        auto y = static_cast<uint32_t>(std::min(std::max(_points[i]->y(), 0.), 1.)*(side - 1));
+        codes[i] = curve == SpaceFillingCurve::MORTON ? mortonCode(x, y) : hilbertCode(x, y, side);
+    }
+
+    std::vector<unsigned long> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](unsigned long i, unsigned long j) {
+        return codes[i] < codes[j];
+    });
+
+    // new allocations in the new order, so that consecutive points are close in memory
+    std::vector<std::shared_ptr<Point>> points;
+    points.reserve(n);
+    for(auto i : order) {
+        points.emplace_back(std::make_shared<Point>(*_points[i]));
+    }
+    _points = std::move(points);
+
+    if(_originalIndices.empty()) {
+        _originalIndices = std::move(order);
+        _nextOriginalIndex = n;
+    }
+    else {
+        for(auto &i : order) {
+            i = _originalIndices[i];
+        }
+        _originalIndices = std::move(order);
+    }
+    return _originalIndices;
+}
+
+unsigned long PointPool::originalIndex(unsigned long pos) const {
+    return _originalIndices.empty() ? pos : _originalIndices[pos];
+}
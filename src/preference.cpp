@@ -0,0 +1,147 @@
+#include "preference.h"
+#include "cluster.h"
+#include "metrics.h"
+#include "trace.h"
+
+PreferenceMatrix::PreferenceMatrix() :
+    _rows {0},
+    _cols {0} {}
+
+PreferenceMatrix::PreferenceMatrix(unsigned long rows, unsigned long cols) :
+    _rows {rows},
+    _cols {cols},
+    _values(rows*cols, 0) {}
+
+template<typename Model>
+static PreferenceMatrix buildFor(const std::vector<Cluster> &clusters, std::vector<Model> models) {
+    TRACE_SCOPE_ARG("preference matrix", "rows", clusters.size());
+    PreferenceMatrix pm(clusters.size(), models.size());
+    unsigned long evaluations = 0;
+
+    #pragma omp parallel reduction(+:evaluations)
+    {
+        TRACE_SCOPE("preference rows");
+
+        #pragma omp for schedule(dynamic)
+        for(long i = 0; i < static_cast<long>(clusters.size()); i++) {
+            const auto &points = clusters[i].points();
+            assert(points.size() > 0);
+            auto pf = pm.row(i);
+
+            // find min PF value for each model
+            for(size_t m = 0; m < models.size(); m++) {
+                auto min = models[m].PFValue(*points[0]);
+                size_t k = 1;
+                for(; k < points.size() && min > 0.; k++) {
+                    min = std::min(min, models[m].PFValue(*points[k]));
+                }
+                pf[m] = PreferencePrecision::store(min);
+                evaluations += k;
+            }
+        }
+    }
+    METRICS_COUNT(Counter::PF_EVALUATIONS, evaluations);
+    return pm;
+}
+
+static PreferenceMatrix buildMixed(const std::vector<Cluster> &clusters,
+                                   std::vector<Line> lines,
+                                   std::vector<Circle> circles) {
+    const auto nLines = lines.size();
+    TRACE_SCOPE_ARG("preference matrix", "rows", clusters.size());
+    PreferenceMatrix pm(clusters.size(), nLines + circles.size());
+    unsigned long evaluations = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+    for(long i = 0; i < static_cast<long>(clusters.size()); i++) {
+        const auto &points = clusters[i].points();
+        assert(points.size() > 0);
+        auto pf = pm.row(i);
+        std::fill(pf, pf + pm.cols(), PreferencePrecision::store(1.));
+
+        // 1 pass over the points for both families
+        for(const auto &point : points) {
+            for(size_t m = 0; m < nLines; m++) {
+                pf[m] = std::min(pf[m], PreferencePrecision::store(lines[m].PFValue(*point)));
+            }
+            for(size_t m = 0; m < circles.size(); m++) {
+                pf[nLines + m] = std::min(pf[nLines + m], PreferencePrecision::store(circles[m].PFValue(*point)));
+            }
+        }
+        evaluations += points.size()*pm.cols();
+    }
+    METRICS_COUNT(Counter::PF_EVALUATIONS, evaluations);
+    return pm;
+}
+
+PreferenceMatrix PreferenceMatrix::build(const PointPool &dataSet, const std::vector<Line> &models) {
+    return buildFor(Cluster::clusterize(dataSet), models);
+}
+
+PreferenceMatrix PreferenceMatrix::build(const PointPool &dataSet, const std::vector<Circle> &models) {
+    return buildFor(Cluster::clusterize(dataSet), models);
+}
+
+PreferenceMatrix PreferenceMatrix::build(const std::vector<Cluster> &clusters, const std::vector<Line> &models) {
+    return buildFor(clusters, models);
+}
+
+PreferenceMatrix PreferenceMatrix::build(const std::vector<Cluster> &clusters, const std::vector<Circle> &models) {
+    return buildFor(clusters, models);
+}
+
+PreferenceMatrix PreferenceMatrix::build(const PointPool &dataSet,
+                                         const std::vector<Line> &lines,
+                                         const std::vector<Circle> &circles) {
+    return buildMixed(Cluster::clusterize(dataSet), lines, circles);
+}
+
+PreferenceMatrix PreferenceMatrix::build(const std::vector<Cluster> &clusters,
+                                         const std::vector<Line> &lines,
+                                         const std::vector<Circle> &circles) {
+    return buildMixed(clusters, lines, circles);
+}
+
+unsigned long PreferenceMatrix::rows() const {
+    return _rows;
+}
+
+unsigned long PreferenceMatrix::cols() const {
+    return _cols;
+}
+
+PreferenceValue *PreferenceMatrix::row(unsigned long i) {
+    return _values.data() + i*_cols;
+}
+
+const PreferenceValue *PreferenceMatrix::row(unsigned long i) const {
+    return _values.data() + i*_cols;
+}
+
+double PreferenceMatrix::distance(unsigned long i, unsigned long j) const {
+    return tanimoto(row(i), row(j), _cols);
+}
+
+void PreferenceMatrix::merge(unsigned long i, unsigned long j) {
+    auto a = row(i);
+    auto b = row(j);
+    for(unsigned long m = 0; m < _cols; m++) {
+        a[m] = std::min(a[m], b[m]);
+    }
+}
+
+ModelFamily PreferenceMatrix::bestFamily(unsigned long i, unsigned long nLines) const {
+    auto pf = row(i);
+    auto bestLine = nLines > 0 ? PreferencePrecision::load(*std::max_element(pf, pf + nLines)) : 0.;
+    auto bestCircle = nLines < _cols ? PreferencePrecision::load(*std::max_element(pf + nLines, pf + _cols)) : 0.;
+
+    if(bestLine <= 0. && bestCircle <= 0.) {
+        return ModelFamily::NONE;
+    }
+    // a line is the simplest model : it wins against (almost) flat circles
+    return bestLine >= MIXED_LINE_TOLERANCE*bestCircle ? ModelFamily::LINE : ModelFamily::CIRCLE;
+}
+
+size_t PreferenceMatrix::bytes() const {
+    return _values.size()*sizeof(PreferenceValue);
+}
@@ -0,0 +1,9 @@
+#include "progress.h"
+
+#include <iostream>
+
+void ProgressLogger::notify(const LinkageProgress &progress) {
+    std::cout << "[DEBUG] Linkage " << (progress.finished ? "done" : "running") << " : "
+              << progress.clusters << " clusters after " << progress.merges << " merges (last distance "
+              << progress.distance << ", " << progress.seconds << " s)" << std::endl;
+}
@@ -0,0 +1,196 @@
+#include "refinement.h"
+#include "trace.h"
+
+/** Line model as a normalized equation nx*x + ny*y + c = 0. */
+struct LineResidual {
+    static constexpr int minSize = 2;
+
+    static void fit(const Cluster &cluster, double params[3]) {
+        auto line = cluster.lineModel();
+        if(line.a() == INFTY) {
+            params[0] = 1.;
+            params[1] = 0.;
+            params[2] = -line.p1().x();
+            return;
+        }
+        auto norm = std::sqrt(line.a()*line.a() + 1);
+        params[0] = line.a()/norm;
+        params[1] = -1./norm;
+        params[2] = line.b()/norm;
+    }
+
+    static inline double residual(const double params[3], double x, double y) {
+        return std::abs(params[0]*x + params[1]*y + params[2]);
+    }
+};
+
+/** Circle model as (center x, center y, radius). */
+struct CircleResidual {
+    static constexpr int minSize = 3;
+
+    static void fit(const Cluster &cluster, double params[3]) {
+        auto circle = cluster.circleModel(true);
+        params[0] = circle.p().x();
+        params[1] = circle.p().y();
+        params[2] = circle.r();
+    }
+
+    static inline double residual(const double params[3], double x, double y) {
+        auto dx = x - params[0];
+        auto dy = y - params[1];
+        return std::abs(std::sqrt(dx*dx + dy*dy) - params[2]);
+    }
+};
+
+/** Residuals of all the points to model k, keeping the closest model of each point. */
+template<typename Residual>
+static void assign(const double *p, const double *x, const double *y, long n, int k, double *bestDist, int *best) {
+    #pragma omp parallel for simd
+    for(long i = 0; i < n; i++) {
+        auto d = Residual::residual(p, x[i], y[i]);
+        if(d < bestDist[i]) {
+            bestDist[i] = d;
+            best[i] = k;
+        }
+    }
+}
+
+/** Clusters labelled as circles get circle models, all the other ones line models. */
+static bool isCircle(ModelFamily family) {
+    return family == ModelFamily::CIRCLE;
+}
+
+static int minSize(ModelFamily family) {
+    return isCircle(family) ? CircleResidual::minSize : LineResidual::minSize;
+}
+
+/**
+ * Refinement loop. Each validated cluster is refitted with the model of the given
+ * family, or with the model of its own family (see Cluster::family()) if family is NONE.
+ */
+static std::vector<Cluster> refineModels(const std::vector<Cluster> &clusters,
+                                         int iterations,
+                                         double threshold,
+                                         ModelFamily family) {
+    TRACE_SCOPE("refinement");
+    // all points, stored contiguously
+    std::vector<std::shared_ptr<Point>> points;
+    std::vector<Cluster> refined;
+    std::vector<ModelFamily> families; // model family of each refined cluster
+
+    for(const auto &cluster : clusters) {
+        auto clusterPoints = cluster.points();
+        points.insert(points.end(), clusterPoints.begin(), clusterPoints.end());
+
+        auto clusterFamily = family == ModelFamily::NONE ? cluster.family() : family;
+
+        // validated clusters only (see Cluster::validate)
+        if(clusterPoints.size() >= minSize(clusterFamily) && clusterPoints[0]->isInlier()) {
+            refined.emplace_back(cluster);
+            families.emplace_back(clusterFamily);
+        }
+    }
+
+    const long n = points.size();
+    std::vector<double> xs(n), ys(n);
+    for(long i = 0; i < n; i++) {
+        xs[i] = points[i]->x();
+        ys[i] = points[i]->y();
+    }
+    const double *x = xs.data();
+    const double *y = ys.data();
+
+    std::vector<int> assignment(n, -1);
+    std::vector<int> previous;
+    std::vector<double> bestDistance(n);
+
+    for(int iter = 0; iter < iterations && !refined.empty(); iter++) {
+        // refit
+        std::vector<double> params(3*refined.size());
+        for(size_t k = 0; k < refined.size(); k++) {
+            if(isCircle(families[k])) {
+                CircleResidual::fit(refined[k], &params[3*k]);
+            }
+            else {
+                LineResidual::fit(refined[k], &params[3*k]);
+            }
+        }
+
+        // reassign
+        std::fill(bestDistance.begin(), bestDistance.end(), threshold);
+        std::fill(assignment.begin(), assignment.end(), -1);
+        int *best = assignment.data();
+        double *bestDist = bestDistance.data();
+
+        for(int k = 0; k < static_cast<int>(refined.size()); k++) {
+            if(isCircle(families[k])) {
+                assign<CircleResidual>(&params[3*k], x, y, n, k, bestDist, best);
+            }
+            else {
+                assign<LineResidual>(&params[3*k], x, y, n, k, bestDist, best);
+            }
+        }
+
+        if(assignment == previous) {
+            break;
+        }
+        previous = assignment;
+
+        // rebuild clusters, dropping the models that lost their points
+        std::vector<Cluster> next(refined.size());
+        for(long i = 0; i < n; i++) {
+            if(assignment[i] >= 0) {
+                next[assignment[i]].addPoint(points[i]);
+            }
+        }
+        std::vector<Cluster> kept;
+        std::vector<ModelFamily> keptFamilies;
+        for(size_t k = 0; k < next.size(); k++) {
+            if(next[k].size() >= minSize(families[k])) {
+                next[k].setFamily(refined[k].family());
+                kept.emplace_back(next[k]);
+                keptFamilies.emplace_back(families[k]);
+            }
+        }
+
+        // indexes changed : assignments must be recomputed before comparing again
+        if(kept.size() != refined.size()) {
+            previous.clear();
+        }
+        refined = kept;
+        families = keptFamilies;
+    }
+    // final flags
+    for(const auto &point : points) {
+        point->reject();
+    }
+
+    for(auto &cluster : refined) {
+        cluster.validate();
+    }
+
+    std::vector<Cluster> outliers;
+    for(long i = 0; i < n; i++) {
+        if(!points[i]->isInlier()) {
+            outliers.emplace_back(Cluster(points[i]));
+        }
+    }
+
+    std::cout << "[DEBUG] Refinement : " << refined.size() << " models, "
+              << outliers.size() << " outliers." << std::endl;
+
+    refined.insert(refined.end(), outliers.begin(), outliers.end());
+    return refined;
+}
+
+std::vector<Cluster> refineLineModels(const std::vector<Cluster> &clusters, int iterations, double threshold) {
+    return refineModels(clusters, iterations, threshold, ModelFamily::LINE);
+}
+
+std::vector<Cluster> refineCircleModels(const std::vector<Cluster> &clusters, int iterations, double threshold) {
+    return refineModels(clusters, iterations, threshold, ModelFamily::CIRCLE);
+}
+
+std::vector<Cluster> refineMixedModels(const std::vector<Cluster> &clusters, int iterations, double threshold) {
+    return refineModels(clusters, iterations, threshold, ModelFamily::NONE);
+}
@@ -0,0 +1,124 @@
+#include "renderer.h"
+
+#include <cstdio>
+
+AsyncRenderer::AsyncRenderer(const std::vector<Cluster> &clusters,
+                             int windowWidth,
+                             int windowHeight,
+                             RenderMode mode,
+                             const std::string &prefix) :
+    _clusters {clusters},
+    _windowWidth {windowWidth},
+    _windowHeight {windowHeight},
+    _mode {mode},
+    _prefix {prefix},
+    _frames {0},
+    _hasPending {false},
+    _stop {false} {
+    _pending.labels.reserve(clusters.size());
+    _drawn.labels.reserve(clusters.size());
+    _thread = std::thread(&AsyncRenderer::loop, this);
+}
+
+AsyncRenderer::~AsyncRenderer() {
+    finish();
+}
+
+void AsyncRenderer::notify(const LinkageProgress &progress) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // same size as the reserved buffer : no allocation
+        _pending.merges = progress.merges;
+        _pending.clusters = progress.clusters;
+        _pending.distance = progress.distance;
+        _pending.seconds = progress.seconds;
+        _pending.finished = progress.finished;
+        _pending.labels.assign(progress.labels.begin(), progress.labels.end());
+        _hasPending = true;
+    }
+    _wakeUp.notify_one();
+}
+
+void AsyncRenderer::finish() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeUp.notify_one();
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+unsigned long AsyncRenderer::frames() const {
+    return _frames;
+}
+
+void AsyncRenderer::loop() {
+    Imagine::Window window;
+    if(_mode == RenderMode::WINDOW) {
+        window = Imagine::openWindow(_windowWidth, _windowHeight, "linkage");
+    }
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeUp.wait(lock, [this] { return _hasPending || _stop; });
+            if(!_hasPending) {
+                return;
+            }
+            std::swap(_pending, _drawn);
+            _hasPending = false;
+        }
+
+        // the linkage may hand new snapshots while this one is drawn
+        if(_mode == RenderMode::WINDOW) {
+            Imagine::setActiveWindow(window);
+            drawWindow(_drawn);
+        }
+        else {
+            drawImage(_drawn);
+        }
+        _frames++;
+    }
+}
+
+void AsyncRenderer::drawWindow(const LinkageProgress &progress) {
+    Imagine::Color cols[] = COLOR_PACK;
+
+    Imagine::noRefreshBegin();
+    Imagine::clearWindow();
+    for(unsigned long i = 0; i < progress.labels.size(); i++) {
+        auto col = cols[progress.labels[i] % N_COLORS];
+        for(const auto &point : _clusters[i].points()) {
+            point->display(col, _windowWidth, _windowHeight);
+        }
+    }
+    Imagine::noRefreshEnd();
+}
+
+void AsyncRenderer::drawImage(const LinkageProgress &progress) {
+    // COLOR_PACK, in BGR
+    const cv::Scalar cols[] = {cv::Scalar(0, 255, 0),
+                               cv::Scalar(0, 0, 255),
+                               cv::Scalar(255, 0, 0),
+                               cv::Scalar(0, 165, 255),
+                               cv::Scalar(128, 0, 128),
+                               cv::Scalar(0, 0, 0),
+                               cv::Scalar(0, 255, 255)};
+
+    cv::Mat image(_windowHeight, _windowWidth, CV_8UC3, cv::Scalar::all(255));
+    for(unsigned long i = 0; i < progress.labels.size(); i++) {
+        const auto &col = cols[progress.labels[i] % N_COLORS];
+        for(const auto &point : _clusters[i].points()) {
+            auto tmp = point->scale(_windowWidth, _windowHeight);
+            cv::circle(image, cv::Point(tmp.x(), tmp.y()), POINT_RADIUS, col, -1);
+        }
+    }
+
+    char path[32];
+    std::snprintf(path, sizeof(path), "%04lu.png", _frames);
+    if(!cv::imwrite(_prefix + path, image)) {
+        fprintf(stderr, "Error : could not write %s%s.\n", _prefix.c_str(), path);
+    }
+}
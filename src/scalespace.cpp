@@ -0,0 +1,142 @@
+#include "scalespace.h"
+#include "trace.h"
+
+ScaleSpace::ScaleSpace() :
+    _type {0} {}
+
+ScaleSpace::ScaleSpace(const cv::Mat &image, int levels) :
+    _type {image.type()} {
+    TRACE_SCOPE_ARG("scale space", "levels", levels);
+    assert(levels >= 1);
+
+    // a kernel of size 1 does not blur
+    _sigmas.emplace_back(0.);
+    for(int l = 1; l < levels; l++) {
+        _sigmas.emplace_back(kernelSigma(2*l + 1));
+    }
+
+    _levels.resize(levels);
+    image.convertTo(_levels[0], CV_MAKETYPE(CV_32F, image.channels()));
+
+    // incremental blurs : variances add up
+    for(int l = 1; l < levels; l++) {
+        auto delta = std::sqrt(_sigmas[l]*_sigmas[l] - _sigmas[l - 1]*_sigmas[l - 1]);
+        cv::GaussianBlur(_levels[l - 1], _levels[l], cv::Size(0, 0), delta);
+    }
+}
+
+double ScaleSpace::kernelSigma(int kernelSize) {
+    assert(kernelSize >= 1 && kernelSize % 2 == 1);
+
+    // see cv::getGaussianKernel : small kernels are fixed tables, not sampled Gaussians,
+    // their standard deviation is the one of the table (sqrt of sum w_i.x_i^2)
+    static const std::vector<std::vector<double>> SMALL_KERNELS {
+        {1.},
+        {0.25, 0.5, 0.25},
+        {0.0625, 0.25, 0.375, 0.25, 0.0625},
+        {0.03125, 0.109375, 0.21875, 0.28125, 0.21875, 0.109375, 0.03125}
+    };
+    if(kernelSize <= 7) {
+        const auto &weights = SMALL_KERNELS[kernelSize/2];
+        double variance = 0.;
+        for(int i = 0; i < kernelSize; i++) {
+            double x = i - kernelSize/2;
+            variance += weights[i]*x*x;
+        }
+        return std::sqrt(variance);
+    }
+    return 0.3*((kernelSize - 1)*0.5 - 1) + 0.8;
+}
+
+int ScaleSpace::levels() const {
+    return _levels.size();
+}
+
+double ScaleSpace::sigma(int level) const {
+    return _sigmas[level];
+}
+
+const cv::Mat &ScaleSpace::level(int level) const {
+    return _levels[level];
+}
+
+cv::Mat ScaleSpace::dog(int level) const {
+    assert(level + 1 < levels());
+
+    // converting back saturates like the difference of 2 images of the original type
+    cv::Mat difference = _levels[level] - _levels[level + 1];
+    cv::Mat out;
+    difference.convertTo(out, _type);
+    return out;
+}
+
+/** Returns the given level as a grey 8 bits image. */
+static cv::Mat greyLevel(const cv::Mat &level) {
+    cv::Mat grey;
+    level.convertTo(grey, CV_MAKETYPE(CV_8U, level.channels()));
+    if(grey.channels() == 3) {
+        cv::cvtColor(grey, grey, cv::COLOR_RGB2GRAY);
+    }
+    return grey;
+}
+
+cv::Mat ScaleSpace::edges(int level) const {
+    TRACE_SCOPE_ARG("scale space edges", "level", level);
+
+    // same as contourCanny, the blur is the one of the level
+    auto grey = greyLevel(_levels[level]);
+    cv::Mat mask;
+    cv::Canny(grey, mask, CANNY_THRESHOLD_1, CANNy_THRESHOLD_2);
+
+    cv::Mat out(grey.size(), grey.type(), cv::Scalar::all(0));
+    grey.copyTo(out, mask);
+    return out;
+}
+
+std::vector<cv::Mat> ScaleSpace::edgeMaps() const {
+    std::vector<cv::Mat> maps(levels());
+
+    #pragma omp parallel for
+    for(int l = 0; l < levels(); l++) {
+        maps[l] = edges(l);
+    }
+    return maps;
+}
+
+PointPool ScaleSpace::extractPoints(int level, int stride) const {
+    cv::Mat grey;
+    if(_levels[level].channels() == 3) {
+        cv::cvtColor(_levels[level], grey, cv::COLOR_RGB2GRAY);
+    }
+    else {
+        grey = _levels[level];
+    }
+
+    // the level is already blurred (see computeGradients)
+    cv::Mat gradX, gradY;
+    cv::Sobel(grey, gradX, CV_32F, 1, 0);
+    cv::Sobel(grey, gradY, CV_32F, 0, 1);
+
+    return extractPointsFromImage(edges(level), gradX, gradY, stride);
+}
+
+PointPool ScaleSpace::extractPointsAcrossScales(int stride) const {
+    TRACE_SCOPE("scale space extraction");
+
+    const int cols = _levels[0].cols;
+    const int rows = _levels[0].rows;
+    std::vector<char> taken(cols*rows, 0);
+    std::vector<std::shared_ptr<Point>> points;
+
+    // finest scales first
+    for(int l = 0; l < levels(); l++) {
+        for(const auto &point : extractPoints(l, stride).points()) {
+            auto pixel = std::lround(point->y()*rows)*cols + std::lround(point->x()*cols);
+            if(!taken[pixel]) {
+                taken[pixel] = 1;
+                points.emplace_back(point);
+            }
+        }
+    }
+    return PointPool(std::move(points));
+}
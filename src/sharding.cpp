@@ -0,0 +1,406 @@
+#include "sharding.h"
+#include "linkage.h"
+#include "trace.h"
+
+#include <atomic>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SHARDING_SUPPORTED 1
+#else
+#define SHARDING_SUPPORTED 0
+#endif
+
+#if SHARDING_SUPPORTED
+
+namespace {
+
+/** Spins of a barrier between 2 checks of the other processes. */
+const unsigned long BARRIER_POLL_INTERVAL = 1024;
+
+/**
+ * Sense reversing barrier between processes. Lock-free atomics are address free,
+ * so they work in a shared mapping (pthread barriers are not available everywhere).
+ */
+struct SharedBarrier {
+    std::atomic<int> count;
+    std::atomic<int> generation;
+    int parties;
+
+    /**
+     * Waits for the other parties. alive() is polled while waiting : a party that
+     * died never reaches the barrier.
+     *
+     * @return false if alive() returned false before the other parties arrived
+     */
+    template<typename Alive>
+    bool wait(Alive alive) {
+        auto gen = generation.load(std::memory_order_acquire);
+        if(count.fetch_add(1, std::memory_order_acq_rel) + 1 == parties) {
+            count.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+        for(unsigned long spins = 1; generation.load(std::memory_order_acquire) == gen; spins++) {
+            if(spins % BARRIER_POLL_INTERVAL == 0 && !alive()) {
+                // the others may have arrived in the meantime
+                return generation.load(std::memory_order_acquire) != gen;
+            }
+            sched_yield();
+        }
+        return true;
+    }
+};
+
+/** Best pair of a worker. */
+struct Candidate {
+    float distance;
+    long row;     // -1 : no candidate
+    long nearest;
+};
+
+/** Header of the shared segment, followed by the candidates and the preference functions. */
+struct SharedHeader {
+    SharedBarrier barrier;
+    long a; // row that b is merged into (-1 : the linkage is over)
+    long b;
+};
+
+/** Views on the shared segment. */
+struct SharedState {
+    SharedHeader *header;
+    Candidate *candidates;
+    PreferenceValue *preferences;
+    unsigned long rows;
+    unsigned long cols;
+    int workers;
+
+    PreferenceValue *row(unsigned long i) const {
+        return preferences + i*cols;
+    }
+
+    unsigned long begin(int w) const {
+        return rows*w/workers;
+    }
+};
+
+size_t alignUp(size_t size) {
+    return (size + 63)/64*64;
+}
+
+/** Same value as Linkage::computeDistance (tanimoto is symmetric). */
+float distance(const SharedState &s, unsigned long i, unsigned long j) {
+    return tanimoto(s.row(i), s.row(j), s.cols);
+}
+
+/**
+ * Worker process : owns the rows [begin(w), begin(w + 1)).
+ *
+ * @return false if the coordinator died
+ */
+bool runWorker(const SharedState &s, int w, const PreferenceMatrix &preferences, pid_t coordinator) {
+    const auto first = s.begin(w);
+    const auto last = s.begin(w + 1);
+    const auto n = s.rows;
+
+    // orphaned workers are adopted by another process
+    auto wait = [&]() {
+        return s.header->barrier.wait([&]() { return getppid() == coordinator; });
+    };
+
+    // first touch of the slice
+    for(auto i = first; i < last; i++) {
+        std::copy(preferences.row(i), preferences.row(i) + s.cols, s.row(i));
+    }
+    if(!wait()) {
+        return false;
+    }
+
+    std::vector<char> active(n, 1);
+    std::vector<long> nearest(n, -1);
+    std::vector<float> nearestDistance(n, 1.f);
+
+    auto updateNearest = [&](unsigned long i) {
+        nearest[i] = -1;
+        nearestDistance[i] = 1.f;
+        for(unsigned long j = 0; j < n; j++) {
+            if(!active[j] || j == i) {
+                continue;
+            }
+            auto d = distance(s, i, j);
+            if(d < nearestDistance[i]) {
+                nearestDistance[i] = d;
+                nearest[i] = j;
+            }
+        }
+    };
+
+    for(auto i = first; i < last; i++) {
+        updateNearest(i);
+    }
+
+    while(true) {
+        // 1. best local pair (first row wins ties, as in Linkage::step)
+        Candidate candidate {1.f, -1, -1};
+        for(auto i = first; i < last; i++) {
+            if(active[i] && nearestDistance[i] < candidate.distance) {
+                candidate = {nearestDistance[i], static_cast<long>(i), nearest[i]};
+            }
+        }
+        s.candidates[w] = candidate;
+        if(!wait()) {
+            return false;
+        }
+
+        // 2. the coordinator decides
+        if(!wait()) {
+            return false;
+        }
+        const long a = s.header->a;
+        const long b = s.header->b;
+        if(a < 0) {
+            break;
+        }
+        active[b] = 0;
+
+        // 3. merge of the preference functions by the owner of a
+        if(a >= static_cast<long>(first) && a < static_cast<long>(last)) {
+            auto pa = s.row(a);
+            auto pb = s.row(b);
+            for(unsigned long m = 0; m < s.cols; m++) {
+                pa[m] = std::min(pa[m], pb[m]);
+            }
+        }
+        if(!wait()) {
+            return false;
+        }
+
+        // 4. nearest neighbours of the owned rows
+        for(auto k = first; k < last; k++) {
+            if(!active[k]) {
+                continue;
+            }
+            if(static_cast<long>(k) == a || nearest[k] == a || nearest[k] == b) {
+                updateNearest(k);
+                continue;
+            }
+            auto d = distance(s, a, k);
+            if(d < nearestDistance[k] || (d == nearestDistance[k] && a < nearest[k])) {
+                nearest[k] = a;
+                nearestDistance[k] = d;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<Cluster> shardedLinkage(const std::vector<Cluster> &clusters,
+                                    const PreferenceMatrix &preferences,
+                                    int workers) {
+    assert(preferences.rows() == clusters.size());
+    TRACE_SCOPE_ARG("sharded linkage", "workers", workers);
+
+    const unsigned long n = clusters.size();
+    workers = std::min<long>(workers, n);
+
+    auto fallback = [&]() {
+        TLinkage linkage(clusters, preferences);
+        linkage.run();
+        return linkage.clusters();
+    };
+    if(workers < 2) {
+        return fallback();
+    }
+
+    // shared segment : header, candidates, preference functions
+    const size_t candidatesOffset = alignUp(sizeof(SharedHeader));
+    const size_t preferencesOffset = candidatesOffset + alignUp(workers*sizeof(Candidate));
+    const size_t size = preferencesOffset + n*preferences.cols()*sizeof(PreferenceValue);
+
+    // the name is only needed until the segment is mapped (children inherit the mapping)
+    auto name = "/tlk-linkage-" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0) {
+        perror("Error : could not create the shared memory segment");
+        return fallback();
+    }
+    shm_unlink(name.c_str());
+
+    void *segment = MAP_FAILED;
+    if(ftruncate(fd, size) == 0) {
+        segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if(segment == MAP_FAILED) {
+        perror("Error : could not map the shared memory segment");
+        return fallback();
+    }
+
+    SharedState s;
+    s.header = new (segment) SharedHeader;
+    s.candidates = reinterpret_cast<Candidate *>(static_cast<char *>(segment) + candidatesOffset);
+    s.preferences = reinterpret_cast<PreferenceValue *>(static_cast<char *>(segment) + preferencesOffset);
+    s.rows = n;
+    s.cols = preferences.cols();
+    s.workers = workers;
+
+    s.header->barrier.count.store(0);
+    s.header->barrier.generation.store(0);
+    s.header->barrier.parties = workers + 1; // workers + coordinator
+
+    // workers must not flush what the coordinator has buffered
+    std::cout.flush();
+    fflush(stdout);
+    fflush(stderr);
+
+    // workers that are still running (-1 : already waited for)
+    std::vector<pid_t> pids;
+
+    // stops the remaining workers and links in this process
+    auto abort = [&]() {
+        for(auto pid : pids) {
+            if(pid > 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+        munmap(segment, size);
+        return fallback();
+    };
+
+    const pid_t coordinator = getpid();
+    for(int w = 0; w < workers; w++) {
+        auto pid = fork();
+        if(pid == 0) {
+            _exit(runWorker(s, w, preferences, coordinator) ? 0 : 1);
+        }
+        if(pid < 0) {
+            perror("Error : could not start the linkage workers");
+            return abort();
+        }
+        pids.emplace_back(pid);
+    }
+
+    // a worker that exits before the end of the linkage died
+    auto workersAlive = [&]() {
+        for(auto &pid : pids) {
+            if(pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+                pid = -1;
+                return false;
+            }
+        }
+        return true;
+    };
+    auto wait = [&]() {
+        if(s.header->barrier.wait(workersAlive)) {
+            return true;
+        }
+        fprintf(stderr, "Error : a linkage worker died, linking in a single process.\n");
+        return false;
+    };
+
+    // coordinator : keeps the chains of initial clusters (see Linkage)
+    std::vector<long> next(n, -1);
+    std::vector<long> last(n);
+    std::vector<unsigned long> sizes(n);
+    std::vector<char> active(n, 1);
+    for(unsigned long i = 0; i < n; i++) {
+        last[i] = i;
+        sizes[i] = clusters[i].points().size();
+    }
+
+    int linkages = 0;
+    if(!wait()) { // slices are written
+        return abort();
+    }
+
+    while(true) {
+        if(!wait()) { // candidates are published
+            return abort();
+        }
+
+        long a = -1;
+        long b = -1;
+        float minDist = 1.f;
+        for(int w = 0; w < workers; w++) {
+            const auto &candidate = s.candidates[w];
+            if(candidate.row >= 0 && candidate.distance < minDist) {
+                minDist = candidate.distance;
+                a = candidate.row;
+                b = candidate.nearest;
+            }
+        }
+
+        // the second cluster should be the smallest for faster merging
+        if(a >= 0 && sizes[a] < sizes[b]) {
+            std::swap(a, b);
+        }
+        s.header->a = a;
+        s.header->b = b;
+        if(!wait()) { // decision is published
+            return abort();
+        }
+
+        if(a < 0) {
+            break;
+        }
+        next[last[a]] = b;
+        last[a] = last[b];
+        sizes[a] += sizes[b];
+        active[b] = 0;
+        linkages++;
+
+        if(!wait()) { // preference functions are merged
+            return abort();
+        }
+    }
+
+    auto ok = true;
+    for(auto pid : pids) {
+        if(pid < 0) {
+            continue;
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    munmap(segment, size);
+    if(!ok) {
+        fprintf(stderr, "Error : a linkage worker failed.\n");
+    }
+
+    std::vector<Cluster> result;
+    for(unsigned long i = 0; i < n; i++) {
+        if(active[i]) {
+            Cluster cluster;
+            for(long k = i; k >= 0; k = next[k]) {
+                cluster.merge(clusters[k]);
+            }
+            result.emplace_back(cluster);
+        }
+    }
+
+    std::cout << "[DEBUG] Sharded linkage : " << workers << " workers, " << linkages << " linkages." << std::endl;
+    return result;
+}
+
+#else
+
+std::vector<Cluster> shardedLinkage(const std::vector<Cluster> &clusters,
+                                    const PreferenceMatrix &preferences,
+                                    int workers) {
+    // no POSIX shared memory : single process
+    TLinkage linkage(clusters, preferences);
+    linkage.run();
+    return linkage.clusters();
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "sweep.h"
+#include "linkage.h"
+#include "trace.h"
+
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+
+ResidualMatrix::ResidualMatrix() :
+    _rows {0},
+    _cols {0} {}
+
+ResidualMatrix::ResidualMatrix(unsigned long rows, unsigned long cols) :
+    _rows {rows},
+    _cols {cols},
+    _values(rows*cols, 0.) {}
+
+template<typename Model>
+static ResidualMatrix buildFor(const PointPool &dataSet, const std::vector<Model> &models) {
+    TRACE_SCOPE_ARG("residual matrix", "rows", dataSet.size());
+    ResidualMatrix rm(dataSet.size(), models.size());
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(long i = 0; i < static_cast<long>(dataSet.size()); i++) {
+        auto r = rm.row(i);
+        for(size_t m = 0; m < models.size(); m++) {
+            r[m] = distance(models[m], *dataSet[i]);
+        }
+    }
+    return rm;
+}
+
+ResidualMatrix ResidualMatrix::build(const PointPool &dataSet, const std::vector<Line> &models) {
+    return buildFor(dataSet, models);
+}
+
+ResidualMatrix ResidualMatrix::build(const PointPool &dataSet, const std::vector<Circle> &models) {
+    return buildFor(dataSet, models);
+}
+
+unsigned long ResidualMatrix::rows() const {
+    return _rows;
+}
+
+unsigned long ResidualMatrix::cols() const {
+    return _cols;
+}
+
+double *ResidualMatrix::row(unsigned long i) {
+    return _values.data() + i*_cols;
+}
+
+const double *ResidualMatrix::row(unsigned long i) const {
+    return _values.data() + i*_cols;
+}
+
+PreferenceMatrix ResidualMatrix::preferences(double tau) const {
+    assert(tau > 0.);
+    PreferenceMatrix pm(_rows, _cols);
+
+    // same formula as Line::PFValue and Circle::PFValue
+    #pragma omp parallel for
+    for(long i = 0; i < static_cast<long>(_rows); i++) {
+        auto r = row(i);
+        auto pf = pm.row(i);
+        for(unsigned long m = 0; m < _cols; m++) {
+            pf[m] = PreferencePrecision::store(r[m] < 5*tau ? exp(-r[m]/tau) : 0);
+        }
+    }
+    return pm;
+}
+
+size_t ResidualMatrix::bytes() const {
+    return _values.size()*sizeof(double);
+}
+
+std::vector<SweepResult> sweepTau(const PointPool &dataSet,
+                                  const ResidualMatrix &residuals,
+                                  const std::vector<double> &taus) {
+    assert(residuals.rows() == dataSet.size());
+    TRACE_SCOPE_ARG("tau sweep", "values", taus.size());
+
+    // row of each point in the residual matrix
+    std::unordered_map<const Point *, unsigned long> rowOf;
+    for(unsigned long i = 0; i < dataSet.size(); i++) {
+        rowOf.emplace(dataSet[i].get(), i);
+    }
+
+    // concurrent linkages share the memory budget
+    long concurrent = std::max(1L, std::min<long>(taus.size(), omp_get_max_threads()));
+    size_t memoryBudget = LINKAGE_MEMORY_BUDGET / concurrent;
+
+    std::vector<SweepResult> results(taus.size());
+
+    // 1 linkage per thread (nested parallel regions run sequentially)
+    #pragma omp parallel for schedule(dynamic)
+    for(long t = 0; t < static_cast<long>(taus.size()); t++) {
+        TRACE_SCOPE("tau sweep run");
+        auto start = std::chrono::steady_clock::now();
+        auto &result = results[t];
+        result.tau = taus[t];
+
+        auto pointPreferences = residuals.preferences(taus[t]);
+        std::vector<Cluster> outliers;
+        auto clusters = Cluster::clusterizeByPreference(dataSet, pointPreferences, outliers);
+
+        // preference of a cluster : minimum over its points (see Cluster::computePF)
+        PreferenceMatrix preferences(clusters.size(), pointPreferences.cols());
+        for(unsigned long c = 0; c < clusters.size(); c++) {
+            auto pf = preferences.row(c);
+            std::fill(pf, pf + preferences.cols(), PreferencePrecision::store(1.));
+
+            for(const auto &point : clusters[c].points()) {
+                auto pointPF = pointPreferences.row(rowOf.at(point.get()));
+                for(unsigned long m = 0; m < preferences.cols(); m++) {
+                    pf[m] = std::min(pf[m], pointPF[m]);
+                }
+            }
+        }
+
+        TLinkage linkage(clusters, preferences, memoryBudget);
+        result.linkages = linkage.run();
+        result.clustering = linkage.clusters();
+        result.clusters = result.clustering.size();
+        result.outliers = outliers.size();
+        result.biggestCluster = 0;
+        for(const auto &cluster : result.clustering) {
+            result.biggestCluster = std::max<unsigned long>(result.biggestCluster, cluster.points().size());
+        }
+        result.clustering.insert(result.clustering.end(), outliers.begin(), outliers.end());
+
+        auto end = std::chrono::steady_clock::now();
+        result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    return results;
+}
+
+void printSweepSummary(const std::vector<SweepResult> &results, std::ostream &out) {
+    out << std::setw(10) << "TAU"
+        << std::setw(10) << "clusters"
+        << std::setw(10) << "outliers"
+        << std::setw(10) << "biggest"
+        << std::setw(10) << "linkages"
+        << std::setw(12) << "time (ms)" << std::endl;
+
+    for(const auto &result : results) {
+        out << std::setw(10) << result.tau
+            << std::setw(10) << result.clusters
+            << std::setw(10) << result.outliers
+            << std::setw(10) << result.biggestCluster
+            << std::setw(10) << result.linkages
+            << std::setw(12) << std::fixed << std::setprecision(1) << result.milliseconds
+            << std::defaultfloat << std::endl;
+    }
+}
@@ -0,0 +1,255 @@
+#include "tiling.h"
+#include "linkage.h"
+#include "sampling.h"
+#include "trace.h"
+
+#include <numeric>
+
+/** Core region of a tile and its extension with the overlap. */
+struct Tile {
+    cv::Rect core;
+    cv::Rect extended;
+};
+
+static std::vector<Tile> makeTiles(int cols, int rows, int tileSize, int overlap) {
+    assert(tileSize > 0 && overlap >= 0);
+
+    std::vector<Tile> tiles;
+    for(int y = 0; y < rows; y += tileSize) {
+        for(int x = 0; x < cols; x += tileSize) {
+            Tile tile;
+            tile.core = cv::Rect(x, y, std::min(tileSize, cols - x), std::min(tileSize, rows - y));
+
+            int x0 = std::max(0, x - overlap);
+            int y0 = std::max(0, y - overlap);
+            int x1 = std::min(cols, x + tileSize + overlap);
+            int y1 = std::min(rows, y + tileSize + overlap);
+            tile.extended = cv::Rect(x0, y0, x1 - x0, y1 - y0);
+            tiles.emplace_back(tile);
+        }
+    }
+    return tiles;
+}
+
+std::vector<cv::Rect> splitInTiles(int cols, int rows, int tileSize, int overlap) {
+    std::vector<cv::Rect> rects;
+    for(const auto &tile : makeTiles(cols, rows, tileSize, overlap)) {
+        rects.emplace_back(tile.extended);
+    }
+    return rects;
+}
+
+/** Returns weither the pixel (x, y) is inside the given region. */
+static bool contains(const cv::Rect &rect, int x, int y) {
+    return x >= rect.x && x < rect.x + rect.width && y >= rect.y && y < rect.y + rect.height;
+}
+
+/** Returns the intersection of 2 regions (empty if they do not overlap). */
+static cv::Rect intersection(const cv::Rect &r1, const cv::Rect &r2) {
+    int x0 = std::max(r1.x, r2.x);
+    int y0 = std::max(r1.y, r2.y);
+    int x1 = std::min(r1.x + r1.width, r2.x + r2.width);
+    int y1 = std::min(r1.y + r1.height, r2.y + r2.height);
+    return x1 > x0 && y1 > y0 ? cv::Rect(x0, y0, x1 - x0, y1 - y0) : cv::Rect(0, 0, 0, 0);
+}
+
+/** Runs the T-Linkage on the points of 1 tile. Outliers are returned as 1 point clusters. */
+static std::vector<Cluster> linkTile(const PointPool &points, size_t memoryBudget) {
+    TRACE_SCOPE_ARG("tile", "points", points.size());
+
+    if(points.size() < TILE_MIN_CLUSTER_SIZE) {
+        return Cluster::clusterize(points);
+    }
+
+    // the sampler gives up on tiles with few distinct lines (ex. 1 straight border)
+    auto models = drawModelsAdaptive<Line>(points, [&](unsigned int n) {
+        return Line::drawModels(std::min<unsigned int>(n, points.size()), points);
+    });
+    if(models.empty()) {
+        return Cluster::clusterize(points);
+    }
+
+    std::vector<Cluster> outliers;
+    auto clusters = Cluster::clusterizeByPreference(points, models, outliers);
+    TLinkage linkage(clusters, PreferenceMatrix::build(clusters, models), memoryBudget);
+    linkage.run();
+
+    clusters = linkage.clusters();
+    clusters.insert(clusters.end(), outliers.begin(), outliers.end());
+    return clusters;
+}
+
+/** Union-find root of element i, with path halving. */
+static unsigned long findRoot(std::vector<unsigned long> &parent, unsigned long i) {
+    while(parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+std::vector<Cluster> tiledLinkage(const cv::Mat &image,
+                                  const cv::Mat &gradX,
+                                  const cv::Mat &gradY,
+                                  PointPool &dataSet,
+                                  int tileSize,
+                                  int overlap) {
+    TRACE_SCOPE("tiled linkage");
+
+    const auto tiles = makeTiles(image.cols, image.rows, tileSize, overlap);
+    const double threshold = EDGE_THRESHOLD_FACTOR*getAveragePixelValueFrom(image);
+    const double cols = image.cols;
+    const double rows = image.rows;
+
+    // concurrent linkages share the memory budget
+    long concurrent = std::max(1L, std::min<long>(tiles.size(), omp_get_max_threads()));
+    size_t memoryBudget = LINKAGE_MEMORY_BUDGET / concurrent;
+
+    // 1. independent tiles (nested parallel regions run sequentially)
+    std::vector<std::vector<Cluster>> tileClusters(tiles.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(long t = 0; t < static_cast<long>(tiles.size()); t++) {
+        auto points = extractPointsFromImage(image, gradX, gradY, tiles[t].extended, threshold);
+        tileClusters[t] = linkTile(points, memoryBudget);
+    }
+
+    // 2. stitching of the big enough clusters of neighbouring tiles
+    struct Candidate {
+        unsigned long tile;
+        const Cluster *cluster;
+        Line line;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<std::vector<unsigned long>> candidatesOf(tiles.size());
+
+    for(unsigned long t = 0; t < tiles.size(); t++) {
+        for(const auto &cluster : tileClusters[t]) {
+            if(cluster.points().size() >= TILE_MIN_CLUSTER_SIZE) {
+                candidatesOf[t].push_back(candidates.size());
+                candidates.push_back({t, &cluster, cluster.lineModel()});
+            }
+        }
+    }
+
+    std::vector<unsigned long> parent(candidates.size());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    // points of a cluster inside the region that are inliers of the line (total counts all of them)
+    auto inliersIn = [&](const Cluster &cluster, const cv::Rect &region, Line line, int &total) {
+        int inliers = 0;
+        for(const auto &point : cluster.points()) {
+            if(contains(region, std::lround(point->x()*cols), std::lround(point->y()*rows))) {
+                total++;
+                inliers += distance(line, *point) < 5*TAU;
+            }
+        }
+        return inliers;
+    };
+
+    // stitches candidates i and j if they continue each other in the overlap region
+    auto stitch = [&](unsigned long i, unsigned long j, const cv::Rect &overlapRegion) {
+        const auto &c1 = candidates[i];
+        const auto &c2 = candidates[j];
+
+        // compatible parameters : same direction and same offset
+        auto dx1 = c1.line.p2().x() - c1.line.p1().x();
+        auto dy1 = c1.line.p2().y() - c1.line.p1().y();
+        auto dx2 = c2.line.p2().x() - c2.line.p1().x();
+        auto dy2 = c2.line.p2().y() - c2.line.p1().y();
+        auto sinAngle = std::abs(dx1*dy2 - dy1*dx2) / std::sqrt((dx1*dx1 + dy1*dy1)*(dx2*dx2 + dy2*dy2));
+        if(!(sinAngle < TILE_ANGLE_TOLERANCE)
+                || distance(c1.line, c2.cluster->moments().centroid()) > 5*TAU
+                || distance(c2.line, c1.cluster->moments().centroid()) > 5*TAU) {
+            return false;
+        }
+
+        // the points of both clusters in the overlap must agree with the other line
+        int total = 0;
+        int agreeing = inliersIn(*c1.cluster, overlapRegion, c2.line, total)
+                     + inliersIn(*c2.cluster, overlapRegion, c1.line, total);
+        if(total == 0 || agreeing < TILE_AGREEMENT*total) {
+            return false;
+        }
+
+        auto r1 = findRoot(parent, i);
+        auto r2 = findRoot(parent, j);
+        if(r1 == r2) {
+            return false;
+        }
+        parent[std::max(r1, r2)] = std::min(r1, r2);
+        return true;
+    };
+
+    // only the clusters of tiles whose extended regions overlap are compared : tiles
+    // are stored row by row, and overlap only within reach tiles of each other
+    const long tilesPerRow = (image.cols + tileSize - 1)/tileSize;
+    const long reach = (2*overlap + tileSize - 1)/tileSize;
+    unsigned long stitches = 0;
+
+    for(long t1 = 0; t1 < static_cast<long>(tiles.size()); t1++) {
+        const long x1 = t1 % tilesPerRow;
+        const long y1 = t1 / tilesPerRow;
+
+        for(long y2 = y1; y2 <= y1 + reach; y2++) {
+            for(long x2 = std::max(0L, x1 - reach); x2 <= std::min(tilesPerRow - 1, x1 + reach); x2++) {
+                const long t2 = y2*tilesPerRow + x2;
+                if(t2 <= t1 || t2 >= static_cast<long>(tiles.size())) {
+                    continue;
+                }
+                auto overlapRegion = intersection(tiles[t1].extended, tiles[t2].extended);
+                if(overlapRegion.width == 0) {
+                    continue;
+                }
+                for(auto i : candidatesOf[t1]) {
+                    for(auto j : candidatesOf[t2]) {
+                        stitches += stitch(i, j, overlapRegion);
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. points are kept by the tile whose core region contains them
+    auto ownedPoints = [&](const Cluster &cluster, unsigned long tile, Cluster &out) {
+        for(const auto &point : cluster.points()) {
+            if(contains(tiles[tile].core, std::lround(point->x()*cols), std::lround(point->y()*rows))) {
+                out.addPoint(point);
+            }
+        }
+    };
+
+    std::vector<Cluster> clusters;
+    std::vector<long> clusterOf(candidates.size(), -1);
+
+    for(unsigned long i = 0; i < candidates.size(); i++) {
+        auto root = findRoot(parent, i);
+        if(clusterOf[root] < 0) {
+            clusterOf[root] = clusters.size();
+            clusters.emplace_back(Cluster());
+        }
+        ownedPoints(*candidates[i].cluster, candidates[i].tile, clusters[clusterOf[root]]);
+    }
+    for(unsigned long t = 0; t < tiles.size(); t++) {
+        for(const auto &cluster : tileClusters[t]) {
+            if(cluster.points().size() < TILE_MIN_CLUSTER_SIZE) {
+                Cluster owned;
+                ownedPoints(cluster, t, owned);
+                clusters.emplace_back(owned);
+            }
+        }
+    }
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(), [](const Cluster &cluster) {
+        return cluster.points().empty();
+    }), clusters.end());
+
+    std::vector<std::shared_ptr<Point>> points;
+    for(const auto &cluster : clusters) {
+        points.insert(points.end(), cluster.points().begin(), cluster.points().end());
+    }
+    dataSet = PointPool(std::move(points));
+
+    std::cout << "[DEBUG] Tiled linkage : " << tiles.size() << " tiles, " << candidates.size()
+              << " tile clusters, " << stitches << " stitches -> " << clusters.size() << " clusters." << std::endl;
+    return clusters;
+}
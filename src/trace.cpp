@@ -0,0 +1,147 @@
+#include "trace.h"
+#include "settings.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/** A recorded event (complete span or counter). */
+struct Event {
+    const char *name;
+    const char *argName;
+    long argValue;
+    long long start;    // ns
+    long long duration; // ns, < 0 for counters
+};
+
+/** Events of a thread. */
+struct ThreadBuffer {
+    int tid;
+    std::vector<Event> events;
+    unsigned long dropped = 0;
+};
+
+std::atomic<bool> tracing {false};
+const auto epoch = std::chrono::steady_clock::now();
+
+// buffers are owned here so that they outlive their thread
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+ThreadBuffer &threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+
+    // first event of this thread : only time a lock is taken
+    if(!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadBuffer);
+        buffer = registry.back().get();
+        buffer->tid = registry.size() - 1;
+        buffer->events.reserve(TRACE_BUFFER_SIZE);
+    }
+    return *buffer;
+}
+
+void record(const Event &event) {
+    auto &buffer = threadBuffer();
+
+    // never reallocate while tracing, the hot loops must stay allocation free
+    if(buffer.events.size() == buffer.events.capacity()) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.emplace_back(event);
+}
+
+} // namespace
+
+void Trace::start() {
+    tracing.store(true, std::memory_order_release);
+}
+
+bool Trace::stop(const std::string &path) {
+    tracing.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::ofstream file(path);
+    if(!file) {
+        return false;
+    }
+
+    // chrome trace timestamps are in microseconds
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    auto first = true;
+    unsigned long dropped = 0;
+
+    for(auto &buffer : registry) {
+        file << (first ? "" : ",\n")
+             << "{\"ph\": \"M\", \"pid\": 0, \"tid\": " << buffer->tid
+             << ", \"name\": \"thread_name\", \"args\": {\"name\": \""
+             << (buffer->tid == 0 ? "main" : "thread " + std::to_string(buffer->tid)) << "\"}}";
+        first = false;
+
+        for(const auto &event : buffer->events) {
+            file << ",\n{\"pid\": 0, \"tid\": " << buffer->tid
+                 << ", \"name\": \"" << event.name
+                 << "\", \"ts\": " << event.start/1000.;
+            if(event.duration < 0) {
+                file << ", \"ph\": \"C\", \"args\": {\"value\": " << event.argValue << "}}";
+                continue;
+            }
+            file << ", \"ph\": \"X\", \"dur\": " << event.duration/1000.;
+            if(event.argName) {
+                file << ", \"args\": {\"" << event.argName << "\": " << event.argValue << "}";
+            }
+            file << "}";
+        }
+        dropped += buffer->dropped;
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+    file << "\n]}\n";
+
+    if(dropped > 0) {
+        fprintf(stderr, "Warning : %lu trace events dropped (TRACE_BUFFER_SIZE is too small).\n", dropped);
+    }
+    return static_cast<bool>(file);
+}
+
+bool Trace::recording() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+long long Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::span(const char *name, long long start, const char *argName, long argValue) {
+    if(recording()) {
+        record({name, argName, argValue, start, now() - start});
+    }
+}
+
+void Trace::counter(const char *name, long value) {
+    if(recording()) {
+        record({name, nullptr, value, now(), -1});
+    }
+}
+
+TraceSpan::TraceSpan(const char *name, const char *argName, long argValue) :
+    _name {name},
+    _argName {argName},
+    _argValue {argValue},
+    _start {Trace::now()} {}
+
+TraceSpan::~TraceSpan() {
+    Trace::span(_name, _start, _argName, _argValue);
+}
+
+void TraceSpan::setArg(const char *argName, long argValue) {
+    _argName = argName;
+    _argValue = argValue;
+}